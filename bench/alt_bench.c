@@ -0,0 +1,126 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file alt_bench.c
+ * @brief Nodes settled per point-to-point query: Dijkstra, bidirectional, ALT.
+ *
+ * Plain Dijkstra is snapshot_find_path_alt without landmarks, the search
+ * graph_find_shortest_path runs with early exit. All searches must agree
+ * on the path cost.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/landmark.h"
+#include "bench_common.h"
+
+#define ALT_QUERIES 200
+
+static const int alt_landmarks[] = { 4, 8, 16 };
+
+typedef struct AltResult_ {
+    long settled;
+    uint64_t ns;
+} AltResult;
+
+static float alt_query(const GraphSnapshot *snap, const GraphSnapshot *reverse, const LandmarkTable *table,
+                       bool bidirectional, int start, int end, AltResult *result) {
+    int settled = 0;
+    uint64_t t0 = bench_now_ns();
+    Path *path = bidirectional ? snapshot_find_path_bidirectional(snap, reverse, start, end, &settled)
+                               : snapshot_find_path_alt(snap, table, start, end, &settled);
+    result->ns += bench_now_ns() - t0;
+    result->settled += settled;
+
+    float cost = path ? path->total_cost : FLT_MAX;
+    path_destroy(path);
+    return cost;
+}
+
+static void alt_print(const char *name, const AltResult *result, const AltResult *plain) {
+    printf("  %-16s %10.0f %8.3f %9.1fx %8.1fx\n", name, (double)result->settled / ALT_QUERIES,
+           result->ns * 1e-6 / ALT_QUERIES, (double)plain->settled / (double)result->settled,
+           (double)plain->ns / (double)result->ns);
+}
+
+static void bench_run(bool directed, int nodes) {
+    unsigned int seed = 23;
+    Graph *graph = bench_lan_graph(directed, nodes, 4, &seed);
+    GraphSnapshot *snap = GraphSnapshotBuild(graph);
+    GraphSnapshot *reverse = directed ? GraphSnapshotReverse(snap) : NULL;
+    int *starts = (int*)MALLOC_S(ALT_QUERIES * sizeof(int));
+    int *ends = (int*)MALLOC_S(ALT_QUERIES * sizeof(int));
+    float *costs = (float*)MALLOC_S(ALT_QUERIES * sizeof(float));
+
+    AltResult plain = { 0, 0 }, bidir = { 0, 0 };
+    for (int q = 0; q < ALT_QUERIES; q++) {
+        starts[q] = 1 + (int)(bench_rand(&seed) % nodes);
+        ends[q] = 1 + (int)(bench_rand(&seed) % nodes);
+        costs[q] = alt_query(snap, NULL, NULL, false, starts[q], ends[q], &plain);
+        float cost = alt_query(snap, reverse, NULL, true, starts[q], ends[q], &bidir);
+        if (cost != costs[q] && (cost == FLT_MAX || costs[q] == FLT_MAX || cost - costs[q] > 1e-3f * costs[q] ||
+                                 costs[q] - cost > 1e-3f * costs[q])) {
+            fprintf(stderr, "bidirectional cost %g, Dijkstra %g\n", cost, costs[q]);
+            exit(1);
+        }
+    }
+
+    printf("%s, %d nodes, %d edges, mean per query\n", directed ? "directed" : "undirected", nodes, snap->edge_count);
+    printf("  %-16s %10s %8s %10s %9s\n", "search", "settled", "ms", "fewer", "faster");
+    alt_print("dijkstra", &plain, &plain);
+    alt_print("bidirectional", &bidir, &plain);
+
+    for (size_t i = 0; i < ARRAY_SIZE(alt_landmarks); i++) {
+        uint64_t t0 = bench_now_ns();
+        LandmarkTable *table = landmark_table_build(snap, alt_landmarks[i]);
+        uint64_t build = bench_now_ns() - t0;
+
+        AltResult alt = { 0, 0 };
+        for (int q = 0; q < ALT_QUERIES; q++) {
+            float cost = alt_query(snap, NULL, table, false, starts[q], ends[q], &alt);
+            if (cost != costs[q] && (cost == FLT_MAX || costs[q] == FLT_MAX || cost - costs[q] > 1e-3f * costs[q] ||
+                                     costs[q] - cost > 1e-3f * costs[q])) {
+                fprintf(stderr, "ALT cost %g, Dijkstra %g\n", cost, costs[q]);
+                exit(1);
+            }
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "alt %d (%.0f ms)", alt_landmarks[i], build * 1e-6);
+        alt_print(name, &alt, &plain);
+        landmark_table_destroy(table);
+    }
+
+    FREE_S(starts);
+    FREE_S(ends);
+    FREE_S(costs);
+    if (reverse) GraphSnapshotDestroy(reverse);
+    GraphSnapshotDestroy(snap);
+    GraphDestroy(graph);
+}
+
+int main(int argc, char **argv) {
+    int max = bench_scale(argc, argv, 100000);
+    printf("%d random queries per graph, alt N (build time) uses N landmarks\n", ALT_QUERIES);
+    for (int nodes = 10000; nodes <= max; nodes *= 10) {
+        bench_run(false, nodes);
+        bench_run(true, nodes);
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file bench_common.h
+ * @brief Timing and LAN-like graph generation shared by the benchmarks.
+ *
+ * Benchmarks are built by `make` but never run by `make check`; each one
+ * prints a small table and takes an optional scale argument.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __BENCH_COMMON_H__
+#define __BENCH_COMMON_H__
+
+#include <time.h>
+
+#include "discovery/graph.h"
+
+#define BENCH_SEGMENT 64    /* Nodes per LAN segment */
+
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* xorshift32, deterministic per seed */
+static inline unsigned int bench_rand(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/* Optional first argument scales the default size */
+static inline int bench_scale(int argc, char **argv, int fallback) {
+    int value = argc > 1 ? atoi(argv[1]) : 0;
+    return value > 0 ? value : fallback;
+}
+
+static inline void bench_device(Device *device, int id) {
+    char hostname[32];
+    snprintf(hostname, sizeof(hostname), "host-%d", id);
+    NodeInit(device, PLAT_LINUX, SUBPLAT_DEBIAN, hostname, "6.1.0", "x86_64");
+    NodeSetPrivateIp(device, "192.168.1.10", NULL);
+    NodeAddInterface(device, "eth0", "192.168.1.10", NULL, "02:00:00:00:00:01", 1500);
+    device->iface = &device->ifaces[0];
+}
+
+/*
+ * Ids 1..nodes in segments of BENCH_SEGMENT. Every node gets `degree` links
+ * inside its segment with sub-millisecond latency, and one in eight nodes an
+ * uplink to a random other segment with WAN-like latency.
+ */
+static inline Graph* bench_lan_graph(bool directed, int nodes, int degree, unsigned int *seed) {
+    Graph *graph = GraphCreate(directed);
+    if (!graph) return NULL;
+
+    GraphBeginUpdate(graph);
+    GraphReserve(graph, nodes);
+    for (int id = 1; id <= nodes; id++) {
+        Device device;
+        bench_device(&device, id);
+        GraphAddNodeWithId(graph, id, device);
+    }
+    for (int id = 1; id <= nodes; id++) {
+        int base = (id - 1) / BENCH_SEGMENT * BENCH_SEGMENT;
+        int span = MIN(BENCH_SEGMENT, nodes - base);
+        EdgeData data = {0};
+        data.bandwidth = 1000;
+
+        // 段内链路，保证段内连通
+        for (int k = 0; k < degree; k++) {
+            int to = k == 0 ? base + 1 + (id - base) % span : base + 1 + (int)(bench_rand(seed) % span);
+            data.latency = 0.1f + (float)(bench_rand(seed) % 100) / 100.0f;
+            if (to != id) GraphAddEdge(graph, id, to, data);
+        }
+        // 跨段上行链路，第一个节点总有一条，保证全图连通
+        if (nodes > span && (id == base + 1 || bench_rand(seed) % 8 == 0)) {
+            int to = 1 + (int)(bench_rand(seed) % nodes);
+            data.bandwidth = 100;
+            data.latency = 5.0f + (float)(bench_rand(seed) % 4500) / 100.0f;
+            if (to != id) GraphAddEdge(graph, id, to, data);
+            if (id == base + 1 && base > 0) GraphAddEdge(graph, id, id - BENCH_SEGMENT, data);
+        }
+    }
+    GraphEndUpdate(graph);
+    return graph;
+}
+
+#endif /* __BENCH_COMMON_H__ */
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file bfs_bench.c
+ * @brief Serial snapshot BFS against the level-synchronous parallel BFS.
+ *
+ * Also times segment labelling with GraphSnapshotComponents. Thread counts
+ * above the online CPU count only show the synchronisation overhead.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/snapshot.h"
+#include "bench_common.h"
+
+#define BFS_REPEAT 5
+
+static const int bfs_threads[] = { 1, 2, 4, 8 };
+static int g_bfs_visited;
+
+static void bfs_visit(int node_id) {
+    (void)node_id;
+    g_bfs_visited++;
+}
+
+static void bench_run(int nodes) {
+    unsigned int seed = 3;
+    Graph *graph = bench_lan_graph(false, nodes, 4, &seed);
+    GraphSnapshot *snap = GraphSnapshotBuild(graph);
+    int *levels = (int*)MALLOC_S(snap->slot_count * sizeof(int));
+
+    uint64_t serial = UINT64_MAX;
+    for (int r = 0; r < BFS_REPEAT; r++) {
+        g_bfs_visited = 0;
+        uint64_t t0 = bench_now_ns();
+        GraphSnapshotBFS(snap, 1, bfs_visit);
+        serial = MIN(serial, bench_now_ns() - t0);
+    }
+    printf("%8d | %8.2f |", nodes, serial * 1e-6);
+
+    for (size_t i = 0; i < ARRAY_SIZE(bfs_threads); i++) {
+        uint64_t best = UINT64_MAX;
+        for (int r = 0; r < BFS_REPEAT; r++) {
+            uint64_t t0 = bench_now_ns();
+            int reached = GraphSnapshotParallelBFS(snap, 1, bfs_threads[i], levels);
+            best = MIN(best, bench_now_ns() - t0);
+            if (reached != g_bfs_visited) {
+                fprintf(stderr, "parallel BFS reached %d of %d\n", reached, g_bfs_visited);
+                exit(1);
+            }
+        }
+        printf(" %8.2f x%-4.2f", best * 1e-6, (double)serial / (double)best);
+    }
+
+    uint64_t t0 = bench_now_ns();
+    int segments = GraphSnapshotComponents(snap, 4, levels);
+    printf(" | %8.2f (%d)\n", (bench_now_ns() - t0) * 1e-6, segments);
+
+    FREE_S(levels);
+    GraphSnapshotDestroy(snap);
+    GraphDestroy(graph);
+}
+
+int main(int argc, char **argv) {
+    int max = bench_scale(argc, argv, 1000000);
+    printf("%ld CPUs online, ms, speed relative to the serial BFS\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("   nodes |   serial |");
+    for (size_t i = 0; i < ARRAY_SIZE(bfs_threads); i++) {
+        printf(" %2d threads    ", bfs_threads[i]);
+    }
+    printf(" | segments x4\n");
+    for (int nodes = 10000; nodes <= max; nodes *= 10) {
+        bench_run(nodes);
+    }
+    return 0;
+}
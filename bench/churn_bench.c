@@ -0,0 +1,153 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file churn_bench.c
+ * @brief Node churn: 5% of a 10k-node graph leave and rejoin every tick.
+ *
+ * GraphRemoveNode only visits the departing node's neighbors. The full-scan
+ * column removes the same nodes the way the old code did, by walking every
+ * node's adjacency for edges into the departing node.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/graph.h"
+#include "bench_common.h"
+
+#define CHURN_TICKS   20
+#define CHURN_PERCENT 5
+
+typedef struct ChurnLink_ {
+    int from;
+    int to;
+    EdgeData data;
+} ChurnLink;
+
+typedef struct ChurnLog_ {
+    ChurnLink *links;
+    int count;
+    int capacity;
+} ChurnLog;
+
+static void churn_log(ChurnLog *log, int from, int to, const EdgeData *data) {
+    if (log->count == log->capacity) {
+        log->capacity = log->capacity ? log->capacity * 2 : 1024;
+        log->links = (ChurnLink*)RELLOC_S(log->links, log->capacity * sizeof(ChurnLink));
+    }
+    log->links[log->count].from = from;
+    log->links[log->count].to = to;
+    log->links[log->count].data = *data;
+    log->count++;
+}
+
+// 记下离开节点的出边和入边，重新加入时恢复
+static void churn_save(Graph *graph, int id, ChurnLog *log) {
+    GraphNode *node = GraphGetNode(graph, id);
+    for (int k = 0; k < node->neighbor_count; k++) {
+        churn_log(log, id, graph->nodes[node->edges[k].slot]->id, &node->edges[k].data);
+    }
+    for (int k = 0; graph->directed && k < node->in_count; k++) {
+        int from = graph->nodes[node->in_slots[k]]->id;
+        churn_log(log, from, id, GraphGetEdge(graph, from, id));
+    }
+}
+
+static void churn_scan_remove(Graph *graph, int id) {
+    int slot = GraphGetSlot(graph, id);
+    for (int i = 0; i < graph->slot_count; i++) {
+        GraphNode *node = graph->nodes[i];
+        for (int k = 0; node && k < node->neighbor_count; k++) {
+            if (node->edges[k].slot == slot) {
+                GraphRemoveEdge(graph, node->id, id);
+                break;
+            }
+        }
+    }
+    GraphRemoveNode(graph, id);
+}
+
+static void bench_run(bool directed, int nodes, bool scan, uint64_t *remove_ns, uint64_t *rejoin_ns) {
+    unsigned int seed = 5;
+    Graph *graph = bench_lan_graph(directed, nodes, 4, &seed);
+    int leaving = nodes * CHURN_PERCENT / 100;
+    int *ids = (int*)MALLOC_S(leaving * sizeof(int));
+    ChurnLog log = { NULL, 0, 0 };
+
+    *remove_ns = *rejoin_ns = 0;
+    for (int tick = 0; tick < CHURN_TICKS; tick++) {
+        log.count = 0;
+        for (int i = 0; i < leaving; i++) {
+            GraphNode *node;
+            // 同一轮内不重复选中，选中的节点先打上标记
+            do {
+                ids[i] = 1 + (int)(bench_rand(&seed) % nodes);
+                node = GraphGetNode(graph, ids[i]);
+            } while (!node || (node->flags & NODE_FLAG_STALE));
+            node->flags |= NODE_FLAG_STALE;
+            churn_save(graph, ids[i], &log);
+        }
+
+        uint64_t t0 = bench_now_ns();
+        GraphBeginUpdate(graph);
+        for (int i = 0; i < leaving; i++) {
+            if (scan) {
+                churn_scan_remove(graph, ids[i]);
+            } else {
+                GraphRemoveNode(graph, ids[i]);
+            }
+        }
+        GraphEndUpdate(graph);
+        uint64_t t1 = bench_now_ns();
+
+        GraphBeginUpdate(graph);
+        for (int i = 0; i < leaving; i++) {
+            Device device;
+            bench_device(&device, ids[i]);
+            GraphAddNodeWithId(graph, ids[i], device);
+        }
+        for (int i = 0; i < log.count; i++) {
+            GraphAddEdge(graph, log.links[i].from, log.links[i].to, log.links[i].data);
+        }
+        GraphEndUpdate(graph);
+        uint64_t t2 = bench_now_ns();
+
+        *remove_ns += t1 - t0;
+        *rejoin_ns += t2 - t1;
+    }
+
+    FREE_S(log.links);
+    FREE_S(ids);
+    GraphDestroy(graph);
+}
+
+int main(int argc, char **argv) {
+    int nodes = bench_scale(argc, argv, 10000);
+    printf("%d nodes, %d%% leave and rejoin per tick, ms per tick\n", nodes, CHURN_PERCENT);
+    printf("           |  remove  full scan  speed |  rejoin\n");
+    for (int directed = 0; directed < 2; directed++) {
+        uint64_t remove_ns, rejoin_ns, scan_ns, unused;
+        bench_run(directed, nodes, false, &remove_ns, &rejoin_ns);
+        bench_run(directed, nodes, true, &scan_ns, &unused);
+        printf("%-10s | %7.3f  %9.3f  x%-4.0f | %7.3f\n", directed ? "directed" : "undirected",
+               remove_ns * 1e-6 / CHURN_TICKS, scan_ns * 1e-6 / CHURN_TICKS,
+               (double)scan_ns / (double)remove_ns, rejoin_ns * 1e-6 / CHURN_TICKS);
+    }
+    return 0;
+}
@@ -0,0 +1,277 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file codec_bench.c
+ * @brief Size and throughput of the binary codec against a JSON encoding.
+ *
+ * The JSON side builds and parses the same fields with jansson, the JSON
+ * library lanpulse_common.h already requires, string escaping included.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/codec.h"
+#include "bench_common.h"
+
+static json_t* json_ip(const IPAddress *ip) {
+    char text[INET6_ADDRSTRLEN] = "";
+    if (ip->family == AF_INET || ip->family == AF_INET6) {
+        inet_ntop(ip->family, &ip->address, text, sizeof(text));
+    }
+    return json_string(text);
+}
+
+// 每个字段一个键，与二进制格式保存的内容相同
+static char* json_encode(Graph *graph, size_t *size) {
+    json_t *nodes = json_array();
+    json_t *edges = json_array();
+    for (int i = 0; i < graph->slot_count; i++) {
+        GraphNode *node = graph->nodes[i];
+        if (!node) continue;
+        const Device *d = GraphNodeDevice(graph, node);
+
+        json_t *ifaces = json_array();
+        for (int k = 0; k < d->iface_count; k++) {
+            json_array_append_new(ifaces, json_pack("{s:s, s:o, s:s, s:I}",
+                                                    "name", str_get(d->ifaces[k].name),
+                                                    "ip", json_ip(&d->ifaces[k].ip),
+                                                    "mac", d->ifaces[k].mac,
+                                                    "mtu", (json_int_t)d->ifaces[k].mtu));
+        }
+        json_array_append_new(nodes, json_pack("{s:i, s:I, s:i, s:i, s:s, s:s, s:s, s:I, s:I, s:o, s:o, s:i, s:o}",
+                                               "id", node->id,
+                                               "flags", (json_int_t)node->flags,
+                                               "platform", (int)d->platform,
+                                               "subplatform", (int)d->subplatform,
+                                               "hostname", str_get(d->hostname),
+                                               "os_version", str_get(d->os_version),
+                                               "architecture", str_get(d->architecture),
+                                               "memory", (json_int_t)d->memory,
+                                               "storage", (json_int_t)d->storage,
+                                               "public_ip", json_ip(&d->public_ip),
+                                               "private_ip", json_ip(&d->private_ip),
+                                               "iface", d->iface ? (int)(d->iface - d->ifaces) : -1,
+                                               "ifaces", ifaces));
+
+        for (int k = 0; k < node->neighbor_count; k++) {
+            const GraphEdge *edge = &node->edges[k];
+            if (!graph->directed && edge->slot < node->slot) continue;
+            const EdgeData *e = &edge->data;
+            json_array_append_new(edges, json_pack("{s:i, s:i, s:i, s:I, s:f, s:f, s:i, s:I, s:I}",
+                                                   "from", node->id,
+                                                   "to", graph->nodes[edge->slot]->id,
+                                                   "utilize", (int)e->utilize,
+                                                   "bandwidth", (json_int_t)e->bandwidth,
+                                                   "latency", (double)e->latency,
+                                                   "packet_loss", (double)e->packet_loss,
+                                                   "port", (int)e->port,
+                                                   "traffic", (json_int_t)e->traffic,
+                                                   "last_communication", (json_int_t)e->last_communication));
+        }
+    }
+
+    json_t *root = json_pack("{s:b, s:o, s:o}", "directed", graph->directed, "nodes", nodes, "edges", edges);
+    // float 的 9 位有效数字足以无损往返
+    char *text = root ? json_dumps(root, JSON_COMPACT | JSON_REAL_PRECISION(9)) : NULL;
+    json_decref(root);
+    *size = text ? strlen(text) : 0;
+    return text;
+}
+
+static bool json_get_ip(const char *text, IPAddress *ip) {
+    memset(ip, 0, sizeof(IPAddress));
+    if (!*text) return true;
+    ip->family = strchr(text, ':') ? AF_INET6 : AF_INET;
+    return inet_pton(ip->family, text, &ip->address) == 1;
+}
+
+static bool json_get_node(Graph *graph, json_t *value) {
+    Device device;
+    memset(&device, 0, sizeof(Device));
+    int id, platform, subplatform, used;
+    json_int_t flags, memory, storage;
+    const char *hostname, *os_version, *architecture, *public_ip, *private_ip;
+    json_t *ifaces;
+    if (json_unpack(value, "{s:i, s:I, s:i, s:i, s:s, s:s, s:s, s:I, s:I, s:s, s:s, s:i, s:o}",
+                    "id", &id, "flags", &flags, "platform", &platform, "subplatform", &subplatform,
+                    "hostname", &hostname, "os_version", &os_version, "architecture", &architecture,
+                    "memory", &memory, "storage", &storage, "public_ip", &public_ip, "private_ip", &private_ip,
+                    "iface", &used, "ifaces", &ifaces) != 0) {
+        return false;
+    }
+    device.platform = (Platform)platform;
+    device.subplatform = (SubPlatType)subplatform;
+    device.hostname = str_intern(hostname);
+    device.os_version = str_intern(os_version);
+    device.architecture = str_intern(architecture);
+    device.memory = (unsigned long)memory;
+    device.storage = (unsigned long)storage;
+    bool ok = json_get_ip(public_ip, &device.public_ip) && json_get_ip(private_ip, &device.private_ip);
+
+    size_t index;
+    json_t *item;
+    json_array_foreach(ifaces, index, item) {
+        const char *name, *ip, *mac;
+        json_int_t mtu;
+        if (!ok || json_unpack(item, "{s:s, s:s, s:s, s:I}", "name", &name, "ip", &ip, "mac", &mac, "mtu", &mtu) != 0 ||
+            strlen(mac) >= sizeof(device.ifaces[0].mac)) {
+            ok = false;
+            break;
+        }
+        NodeAddInterface(&device, NULL, NULL, NULL, NULL, 0);
+        NetworkInterface *iface = &device.ifaces[device.iface_count - 1];
+        iface->name = str_intern(name);
+        strcpy(iface->mac, mac);
+        iface->mtu = (unsigned int)mtu;
+        ok = json_get_ip(ip, &iface->ip);
+    }
+    if (used >= 0 && used < device.iface_count) device.iface = &device.ifaces[used];
+
+    GraphNode *node = ok ? GraphAddNodeWithId(graph, id, device) : NULL;
+    if (!node) {
+        NodeRelease(&device);
+        return false;
+    }
+    node->flags = (unsigned int)flags;
+    return true;
+}
+
+static bool json_get_edge(Graph *graph, json_t *value) {
+    EdgeData data;
+    memset(&data, 0, sizeof(EdgeData));
+    int from, to, utilize, port;
+    json_int_t bandwidth, traffic, last_communication;
+    double latency, packet_loss;
+    if (json_unpack(value, "{s:i, s:i, s:i, s:I, s:f, s:f, s:i, s:I, s:I}",
+                    "from", &from, "to", &to, "utilize", &utilize, "bandwidth", &bandwidth,
+                    "latency", &latency, "packet_loss", &packet_loss, "port", &port,
+                    "traffic", &traffic, "last_communication", &last_communication) != 0) {
+        return false;
+    }
+    data.utilize = (char)utilize;
+    data.bandwidth = (unsigned int)bandwidth;
+    data.latency = (float)latency;
+    data.packet_loss = (float)packet_loss;
+    data.port = (unsigned short)port;
+    data.traffic = (unsigned long)traffic;
+    data.last_communication = (time_t)last_communication;
+    return GraphAddEdge(graph, from, to, data);
+}
+
+static Graph* json_decode(const char *text) {
+    json_error_t error;
+    json_t *root = json_loads(text, 0, &error);
+    int directed;
+    json_t *nodes, *edges;
+    if (!root || json_unpack(root, "{s:b, s:o, s:o}", "directed", &directed, "nodes", &nodes, "edges", &edges) != 0) {
+        json_decref(root);
+        return NULL;
+    }
+
+    Graph *graph = GraphCreate(directed != 0);
+    bool ok = graph != NULL;
+    size_t index;
+    json_t *value;
+    if (ok) {
+        GraphBeginUpdate(graph);
+        json_array_foreach(nodes, index, value) {
+            if (!(ok = json_get_node(graph, value))) break;
+        }
+        json_array_foreach(edges, index, value) {
+            if (!ok || !(ok = json_get_edge(graph, value))) break;
+        }
+        GraphEndUpdate(graph);
+    }
+    json_decref(root);
+
+    if (!ok) {
+        GraphDestroy(graph);
+        return NULL;
+    }
+    return graph;
+}
+
+static void bench_run(int nodes, int rounds) {
+    unsigned int seed = 7;
+    Graph *graph = bench_lan_graph(false, nodes, 4, &seed);
+    int edges = 0;
+    for (int i = 0; i < graph->slot_count; i++) {
+        EdgeData *data;
+        for (int k = 0; graph->nodes[i] && k < graph->nodes[i]->neighbor_count; k++) {
+            data = &graph->nodes[i]->edges[k].data;
+            data->traffic = bench_rand(&seed);
+            data->last_communication = 1700000000 + bench_rand(&seed) % 600;
+            data->port = 7000;
+            edges++;
+        }
+    }
+
+    size_t bin_size = 0, json_size = 0;
+    uint64_t bin_enc = 0, bin_dec = 0, json_enc = 0, json_dec = 0;
+    for (int i = 0; i < rounds; i++) {
+        uint64_t t0 = bench_now_ns();
+        void *bin = GraphEncode(graph, &bin_size);
+        uint64_t t1 = bench_now_ns();
+        Graph *a = GraphDecode(bin, bin_size);
+        uint64_t t2 = bench_now_ns();
+        char *json = json_encode(graph, &json_size);
+        uint64_t t3 = bench_now_ns();
+        Graph *b = json_decode(json);
+        uint64_t t4 = bench_now_ns();
+
+        // 两种格式解码出的图必须再编码成同样的字节
+        size_t x_size = 0, y_size = 0;
+        void *x = a ? GraphEncode(a, &x_size) : NULL;
+        void *y = b ? GraphEncode(b, &y_size) : NULL;
+        if (!x || !y || x_size != y_size || memcmp(x, y, x_size) != 0) {
+            fprintf(stderr, "decode mismatch\n");
+            exit(1);
+        }
+        FREE_S(x);
+        FREE_S(y);
+        bin_enc += t1 - t0;
+        bin_dec += t2 - t1;
+        json_enc += t3 - t2;
+        json_dec += t4 - t3;
+        GraphDestroy(a);
+        GraphDestroy(b);
+        FREE_S(bin);
+        FREE_S(json);
+    }
+
+    double ms = 1e-6 / rounds;
+    printf("%7d %8d | %9zu %8.2f %8.2f | %9zu %8.2f %8.2f | x%-4.1f x%-5.1f x%.1f\n",
+           nodes, edges / 2,
+           bin_size, bin_enc * ms, bin_dec * ms,
+           json_size, json_enc * ms, json_dec * ms,
+           (double)json_size / (double)bin_size,
+           (double)json_enc / (double)bin_enc, (double)json_dec / (double)bin_dec);
+    GraphDestroy(graph);
+}
+
+int main(int argc, char **argv) {
+    int rounds = bench_scale(argc, argv, 10);
+    printf("                 |          binary           |           json            |   json / binary\n");
+    printf("  nodes    edges |   bytes   enc ms   dec ms |   bytes   enc ms   dec ms | size   enc    dec\n");
+    bench_run(1000, rounds);
+    bench_run(10000, rounds);
+    bench_run(50000, MAX(rounds / 5, 1));
+    return 0;
+}
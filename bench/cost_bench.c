@@ -0,0 +1,125 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file cost_bench.c
+ * @brief Profile-specialized Dijkstra against the same cost as a callback.
+ *
+ * For every profile the full shortest-path tree is built twice from the
+ * same sources: once through snapshot_dijkstra_profile, which inlines the
+ * cost into the relaxation loop, and once through snapshot_dijkstra_custom
+ * with a function pointer to the very same cost function.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/router.h"
+#include "bench_common.h"
+
+#define COST_SOURCES 20
+
+static float cost_latency_fn(const GraphSnapshot *snap, int e, void *arg) {
+    (void)arg;
+    return route_cost_latency(snap, e);
+}
+
+static float cost_interactive_fn(const GraphSnapshot *snap, int e, void *arg) {
+    (void)arg;
+    return route_cost_interactive(snap, e);
+}
+
+static float cost_bulk_fn(const GraphSnapshot *snap, int e, void *arg) {
+    (void)arg;
+    return route_cost_bulk(snap, e);
+}
+
+static float cost_control_fn(const GraphSnapshot *snap, int e, void *arg) {
+    (void)arg;
+    return route_cost_control(snap, e);
+}
+
+static const struct {
+    const char *name;
+    RouteProfile profile;
+    RouteCostFn fn;
+} cost_profiles[] = {
+    { "latency",     ROUTE_PROFILE_LATENCY,     cost_latency_fn },
+    { "interactive", ROUTE_PROFILE_INTERACTIVE, cost_interactive_fn },
+    { "bulk",        ROUTE_PROFILE_BULK,        cost_bulk_fn },
+    { "control",     ROUTE_PROFILE_CONTROL,     cost_control_fn },
+};
+
+static void bench_run(int nodes) {
+    unsigned int seed = 19;
+    Graph *graph = bench_lan_graph(false, nodes, 4, &seed);
+    // 部分链路有丢包，带宽不一
+    for (int i = 0; i < graph->slot_count; i++) {
+        GraphNode *node = graph->nodes[i];
+        for (int k = 0; node && k < node->neighbor_count; k++) {
+            node->edges[k].data.packet_loss = bench_rand(&seed) % 4 ? 0.0f : (float)(bench_rand(&seed) % 500) / 100.0f;
+            node->edges[k].data.bandwidth = bench_rand(&seed) % 8 ? node->edges[k].data.bandwidth : 0;
+        }
+    }
+    GraphSnapshot *snap = GraphSnapshotBuild(graph);
+    int count = snap->slot_count;
+    float *a = (float*)MALLOC_S(count * sizeof(float));
+    float *b = (float*)MALLOC_S(count * sizeof(float));
+    int *previous = (int*)MALLOC_S(count * sizeof(int));
+    MemArena *scratch = router_scratch();
+
+    for (size_t p = 0; p < ARRAY_SIZE(cost_profiles); p++) {
+        uint64_t inlined = 0, callback = 0;
+        for (int s = 0; s < COST_SOURCES; s++) {
+            int start = GraphSnapshotGetSlot(snap, 1 + (int)((unsigned int)s * 7919u % (unsigned int)nodes));
+            MemArenaMark mark = mem_arena_mark(scratch);
+            uint64_t t0 = bench_now_ns();
+            snapshot_dijkstra_profile(snap, cost_profiles[p].profile, start, GRAPH_INVALID_SLOT, scratch, a, previous);
+            uint64_t t1 = bench_now_ns();
+            mem_arena_release(scratch, mark);
+            snapshot_dijkstra_custom(snap, cost_profiles[p].fn, NULL, start, GRAPH_INVALID_SLOT, scratch, b, previous);
+            uint64_t t2 = bench_now_ns();
+            mem_arena_release(scratch, mark);
+
+            if (memcmp(a, b, count * sizeof(float)) != 0) {
+                fprintf(stderr, "%s: callback and specialized trees differ\n", cost_profiles[p].name);
+                exit(1);
+            }
+            inlined += t1 - t0;
+            callback += t2 - t1;
+        }
+        printf("%7d %-11s | %8.3f %8.3f  x%.2f\n", nodes, cost_profiles[p].name,
+               inlined * 1e-6 / COST_SOURCES, callback * 1e-6 / COST_SOURCES, (double)callback / (double)inlined);
+    }
+
+    FREE_S(a);
+    FREE_S(b);
+    FREE_S(previous);
+    GraphSnapshotDestroy(snap);
+    GraphDestroy(graph);
+}
+
+int main(int argc, char **argv) {
+    int max = bench_scale(argc, argv, 100000);
+    printf("full shortest-path tree, ms per source\n");
+    printf("  nodes profile     |  inlined callback  callback cost\n");
+    for (int nodes = 10000; nodes <= max; nodes *= 10) {
+        bench_run(nodes);
+    }
+    return 0;
+}
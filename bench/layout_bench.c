@@ -0,0 +1,252 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file layout_bench.c
+ * @brief BFS and Dijkstra over the hot/cold node layout against the old one.
+ *
+ * The old layout is rebuilt here from the same graph: a node embedding the
+ * whole Device with fixed string buffers, neighbor pointers and one heap
+ * allocation per EdgeData. Both layouts run the same BFS and heap Dijkstra
+ * kernels, so only the memory layout differs.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/graph.h"
+#include "util/heap.h"
+#include "bench_common.h"
+
+#define LAYOUT_REPEAT 5
+
+/* Device before the split, strings stored inline */
+typedef struct FatDevice_ {
+    Platform platform;
+    SubPlatType subplatform;
+    char hostname[128];
+    char os_version[32];
+    char architecture[16];
+    unsigned long memory;
+    unsigned long storage;
+    IPAddress public_ip;
+    IPAddress private_ip;
+    NetworkInterface *ifaces;
+    NetworkInterface *iface;
+    int iface_count;
+    void *data;
+} FatDevice;
+
+typedef struct FatNode_ {
+    int id;
+    int slot;
+    FatDevice data;
+    struct FatNode_ **neighbors;
+    EdgeData **edge_data;
+    int neighbor_count;
+    int capacity;
+} FatNode;
+
+static FatNode** fat_build(Graph *graph) {
+    FatNode **nodes = (FatNode**)CALLOC_S(graph->slot_count, sizeof(FatNode*));
+    for (int i = 0; i < graph->slot_count; i++) {
+        GraphNode *node = graph->nodes[i];
+        if (!node) continue;
+        const Device *device = GraphNodeDevice(graph, node);
+        FatNode *fat = (FatNode*)CALLOC_S(1, sizeof(FatNode));
+        fat->id = node->id;
+        fat->slot = i;
+        fat->data.platform = device->platform;
+        snprintf(fat->data.hostname, sizeof(fat->data.hostname), "%s", str_get(device->hostname));
+        fat->data.public_ip = device->public_ip;
+        fat->capacity = MAX(node->neighbor_count, 1);
+        fat->neighbors = (FatNode**)MALLOC_S(fat->capacity * sizeof(FatNode*));
+        fat->edge_data = (EdgeData**)MALLOC_S(fat->capacity * sizeof(EdgeData*));
+        nodes[i] = fat;
+    }
+    // 旧实现每条边单独分配 EdgeData
+    for (int i = 0; i < graph->slot_count; i++) {
+        GraphNode *node = graph->nodes[i];
+        for (int k = 0; node && k < node->neighbor_count; k++) {
+            FatNode *fat = nodes[i];
+            fat->neighbors[fat->neighbor_count] = nodes[node->edges[k].slot];
+            fat->edge_data[fat->neighbor_count] = (EdgeData*)MALLOC_S(sizeof(EdgeData));
+            *fat->edge_data[fat->neighbor_count] = node->edges[k].data;
+            fat->neighbor_count++;
+        }
+    }
+    return nodes;
+}
+
+static void fat_destroy(FatNode **nodes, int count) {
+    for (int i = 0; i < count; i++) {
+        if (!nodes[i]) continue;
+        for (int k = 0; k < nodes[i]->neighbor_count; k++) {
+            FREE_S(nodes[i]->edge_data[k]);
+        }
+        FREE_S(nodes[i]->neighbors);
+        FREE_S(nodes[i]->edge_data);
+        FREE_S(nodes[i]);
+    }
+    FREE_S(nodes);
+}
+
+// 两种布局的内核逐行对应，只有取邻居的方式不同
+static long hot_bfs(Graph *graph, int start, int *queue, uint8_t *seen) {
+    long sum = 0;
+    int head = 0, tail = 0;
+    memset(seen, 0, graph->slot_count);
+    queue[tail++] = start;
+    seen[start] = 1;
+    while (head < tail) {
+        GraphNode *node = graph->nodes[queue[head++]];
+        sum += node->id;
+        for (int k = 0; k < node->neighbor_count; k++) {
+            int next = node->edges[k].slot;
+            if (!seen[next]) {
+                seen[next] = 1;
+                queue[tail++] = next;
+            }
+        }
+    }
+    return sum;
+}
+
+static long fat_bfs(FatNode **nodes, int count, int start, int *queue, uint8_t *seen) {
+    long sum = 0;
+    int head = 0, tail = 0;
+    memset(seen, 0, count);
+    queue[tail++] = start;
+    seen[start] = 1;
+    while (head < tail) {
+        FatNode *node = nodes[queue[head++]];
+        sum += node->id;
+        for (int k = 0; k < node->neighbor_count; k++) {
+            int next = node->neighbors[k]->slot;
+            if (!seen[next]) {
+                seen[next] = 1;
+                queue[tail++] = next;
+            }
+        }
+    }
+    return sum;
+}
+
+static float hot_dijkstra(Graph *graph, int start, float *dist, MemArena *arena) {
+    MemArenaMark mark = mem_arena_mark(arena);
+    IndexedHeap heap;
+    heap_arena_init(&heap, arena, graph->slot_count);
+    for (int i = 0; i < graph->slot_count; i++) dist[i] = FLT_MAX;
+    dist[start] = 0;
+    heap_push_or_decrease(&heap, start, 0);
+    float sum = 0;
+    while (!heap_empty(&heap)) {
+        float d;
+        GraphNode *node = graph->nodes[heap_pop(&heap, &d)];
+        sum += d;
+        for (int k = 0; k < node->neighbor_count; k++) {
+            int next = node->edges[k].slot;
+            float nd = d + node->edges[k].data.latency;
+            if (nd < dist[next]) {
+                dist[next] = nd;
+                heap_push_or_decrease(&heap, next, nd);
+            }
+        }
+    }
+    mem_arena_release(arena, mark);
+    return sum;
+}
+
+static float fat_dijkstra(FatNode **nodes, int count, int start, float *dist, MemArena *arena) {
+    MemArenaMark mark = mem_arena_mark(arena);
+    IndexedHeap heap;
+    heap_arena_init(&heap, arena, count);
+    for (int i = 0; i < count; i++) dist[i] = FLT_MAX;
+    dist[start] = 0;
+    heap_push_or_decrease(&heap, start, 0);
+    float sum = 0;
+    while (!heap_empty(&heap)) {
+        float d;
+        FatNode *node = nodes[heap_pop(&heap, &d)];
+        sum += d;
+        for (int k = 0; k < node->neighbor_count; k++) {
+            int next = node->neighbors[k]->slot;
+            float nd = d + node->edge_data[k]->latency;
+            if (nd < dist[next]) {
+                dist[next] = nd;
+                heap_push_or_decrease(&heap, next, nd);
+            }
+        }
+    }
+    mem_arena_release(arena, mark);
+    return sum;
+}
+
+static void bench_run(int nodes) {
+    unsigned int seed = 11;
+    Graph *graph = bench_lan_graph(false, nodes, 4, &seed);
+    FatNode **fat = fat_build(graph);
+    int count = graph->slot_count;
+    int *queue = (int*)MALLOC_S(count * sizeof(int));
+    uint8_t *seen = (uint8_t*)MALLOC_S(count);
+    float *dist = (float*)MALLOC_S(count * sizeof(float));
+    MemArena *arena = mem_thread_arena();
+
+    uint64_t best[4] = { UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX };
+    for (int r = 0; r < LAYOUT_REPEAT; r++) {
+        int start = (int)(bench_rand(&seed) % count);
+        uint64_t t0 = bench_now_ns();
+        long a = hot_bfs(graph, start, queue, seen);
+        uint64_t t1 = bench_now_ns();
+        long b = fat_bfs(fat, count, start, queue, seen);
+        uint64_t t2 = bench_now_ns();
+        float c = hot_dijkstra(graph, start, dist, arena);
+        uint64_t t3 = bench_now_ns();
+        float d = fat_dijkstra(fat, count, start, dist, arena);
+        uint64_t t4 = bench_now_ns();
+        if (a != b || c != d) {
+            fprintf(stderr, "layouts disagree\n");
+            exit(1);
+        }
+        best[0] = MIN(best[0], t1 - t0);
+        best[1] = MIN(best[1], t2 - t1);
+        best[2] = MIN(best[2], t3 - t2);
+        best[3] = MIN(best[3], t4 - t3);
+    }
+
+    printf("%7d | %8.3f %8.3f  x%-5.2f | %8.3f %8.3f  x%.2f\n", nodes,
+           best[1] * 1e-6, best[0] * 1e-6, (double)best[1] / (double)best[0],
+           best[3] * 1e-6, best[2] * 1e-6, (double)best[3] / (double)best[2]);
+
+    FREE_S(queue);
+    FREE_S(seen);
+    FREE_S(dist);
+    fat_destroy(fat, count);
+    GraphDestroy(graph);
+}
+
+int main(int argc, char **argv) {
+    int max = bench_scale(argc, argv, 100000);
+    printf("node bytes: old %zu, hot %zu\n", sizeof(FatNode), sizeof(GraphNode));
+    printf("        |        BFS ms            |    Dijkstra ms\n");
+    printf("  nodes |      old      hot  speed |      old      hot  speed\n");
+    for (int nodes = 1000; nodes <= max; nodes *= 10) {
+        bench_run(nodes);
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file sptree_bench.c
+ * @brief Incremental shortest-path tree repair against a full recompute.
+ *
+ * Latency probes rewrite random edges by a jitter of up to +/-20%, and one
+ * probe in ten reports a spike of 10x. After every round of probes the
+ * tree is synced from the journal and, separately, recomputed from scratch.
+ * Every repaired tree is checked against the recomputed one.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/sptree.h"
+#include "bench_common.h"
+
+#define SPTREE_ROUNDS 200
+
+static const int sptree_probes[] = { 1, 4, 16, 64 };
+
+static void sptree_probe(Graph *graph, int nodes, unsigned int *seed) {
+    GraphNode *node;
+    do {
+        node = GraphGetNode(graph, 1 + (int)(bench_rand(seed) % nodes));
+    } while (!node || node->neighbor_count == 0);
+
+    GraphEdge *edge = &node->edges[bench_rand(seed) % node->neighbor_count];
+    EdgeData data = edge->data;
+    if (bench_rand(seed) % 10 == 0) {
+        data.latency *= 10.0f;
+    } else {
+        data.latency *= 0.8f + (float)(bench_rand(seed) % 400) / 1000.0f;
+    }
+    data.latency = MAX(data.latency, 0.05f);
+    data.latency = MIN(data.latency, 500.0f);
+    GraphAddEdge(graph, node->id, graph->nodes[edge->slot]->id, data);
+}
+
+static void sptree_check(const ShortestPathTree *a, const ShortestPathTree *b, int count) {
+    for (int i = 0; i < count; i++) {
+        float x = a->distances[i], y = b->distances[i];
+        if (x != y && (x == FLT_MAX || y == FLT_MAX || x - y > 1e-3f * y || y - x > 1e-3f * y)) {
+            fprintf(stderr, "slot %d: repaired %g, recomputed %g\n", i, x, y);
+            exit(1);
+        }
+    }
+}
+
+static void bench_run(int nodes, int probes) {
+    unsigned int seed = 17;
+    Graph *graph = bench_lan_graph(false, nodes, 4, &seed);
+    GraphEnableJournal(graph, 4096);
+    ShortestPathTree *repaired = sptree_create(graph, 1);
+    ShortestPathTree *full = sptree_create(graph, 1);
+
+    uint64_t repair_ns = 0, recompute_ns = 0;
+    for (int round = 0; round < SPTREE_ROUNDS; round++) {
+        for (int i = 0; i < probes; i++) {
+            sptree_probe(graph, nodes, &seed);
+        }
+        uint64_t t0 = bench_now_ns();
+        sptree_sync(repaired, graph);
+        uint64_t t1 = bench_now_ns();
+        sptree_recompute(full, graph);
+        uint64_t t2 = bench_now_ns();
+        repair_ns += t1 - t0;
+        recompute_ns += t2 - t1;
+        sptree_check(repaired, full, graph->slot_count);
+    }
+
+    const ShortestPathTreeStats *stats = &repaired->stats;
+    printf("%7d %6d | %8.1f %9.1f  x%-6.1f | %7lu %7lu %9.1f\n", nodes, probes,
+           repair_ns * 1e-3 / SPTREE_ROUNDS, recompute_ns * 1e-3 / SPTREE_ROUNDS,
+           (double)recompute_ns / (double)repair_ns, stats->repairs, stats->recomputes,
+           stats->repairs ? (double)stats->touched / (double)stats->repairs : 0.0);
+
+    sptree_destroy(repaired);
+    sptree_destroy(full);
+    GraphDestroy(graph);
+}
+
+int main(int argc, char **argv) {
+    int max = bench_scale(argc, argv, 100000);
+    printf("%d syncs per row, us per sync\n", SPTREE_ROUNDS);
+    printf("  nodes probes |   repair recompute  speed   | repairs recomp. touched\n");
+    for (int nodes = 1000; nodes <= max; nodes *= 10) {
+        for (size_t i = 0; i < ARRAY_SIZE(sptree_probes); i++) {
+            bench_run(nodes, sptree_probes[i]);
+        }
+    }
+    return 0;
+}
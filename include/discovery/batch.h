@@ -0,0 +1,69 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file batch.h
+ * @brief Batched topology mutations applied in one pass with one version bump.
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __BATCH_H__
+#define __BATCH_H__
+
+#include "discovery/graph.h"
+
+/* Operation, the value is also the order of application */
+typedef enum {
+    GRAPH_OP_REMOVE_EDGE = 0,
+    GRAPH_OP_REMOVE_NODE,
+    GRAPH_OP_UPSERT_NODE,
+    GRAPH_OP_UPSERT_EDGE,
+    GRAPH_OP_MAX
+} GraphOpType;
+
+typedef struct GraphOp_ {
+    GraphOpType type;
+    int from_id;                /* Node id for node operations */
+    int to_id;
+    union {
+        Device device;          /* Owned by the batch until applied */
+        EdgeData edge;
+    } data;
+} GraphOp;
+
+typedef struct GraphBatch_ {
+    GraphOp *ops;
+    int count;
+    int capacity;
+} GraphBatch;
+
+/* Function */
+
+void GraphBatchInit(GraphBatch *batch);
+void GraphBatchClear(GraphBatch *batch);
+void GraphBatchFree(GraphBatch *batch);
+
+bool GraphBatchUpsertNode(GraphBatch *batch, int node_id, Device data);
+bool GraphBatchRemoveNode(GraphBatch *batch, int node_id);
+bool GraphBatchUpsertEdge(GraphBatch *batch, int from_id, int to_id, EdgeData data);
+bool GraphBatchRemoveEdge(GraphBatch *batch, int from_id, int to_id);
+
+int GraphApplyBatch(Graph *graph, GraphBatch *batch);
+
+#endif /* __BATCH_H__ */
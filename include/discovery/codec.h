@@ -0,0 +1,52 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file codec.h
+ * @brief Compact binary topology encoding for master-to-master sync.
+ *
+ * Layout: fixed header, then every node, then every edge. Ids and edge
+ * targets are zigzag varint deltas. Strings are sent once and referenced
+ * by index afterwards. Edge metrics are deltas against the previous edge,
+ * with floats XOR'ed bitwise so repeated values cost one byte. Undirected
+ * edges are sent once. All integers are little endian.
+ *
+ * Decoding interns strings straight from the input and allocates nodes
+ * and adjacency from the graph's slab pools, with no intermediate copy.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __CODEC_H__
+#define __CODEC_H__
+
+#include "discovery/graph.h"
+
+#define GRAPH_CODEC_MAGIC  "LPG"
+#define GRAPH_CODEC_FORMAT 1
+
+#define GRAPH_CODEC_DIRECTED BIT_U32(0)
+
+/* Function */
+
+void* GraphEncode(Graph *graph, size_t *size);
+int GraphDecodeInto(Graph *graph, const void *buf, size_t size);
+Graph* GraphDecode(const void *buf, size_t size);
+
+#endif /* __CODEC_H__ */
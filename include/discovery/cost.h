@@ -0,0 +1,90 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file cost.h
+ * @brief Edge cost profiles for routing.
+ *
+ * A profile turns the latency, loss and bandwidth columns of a snapshot
+ * edge into one non-negative cost. The router instantiates its search once
+ * per profile with the profile as a constant, so the cost is inlined into
+ * the relaxation loop. Anything else goes through RouteCostFn, which costs
+ * an indirect call per edge.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __COST_H__
+#define __COST_H__
+
+#include "discovery/snapshot.h"
+
+typedef enum {
+    ROUTE_PROFILE_LATENCY = 0,  /* Raw latency, the default */
+    ROUTE_PROFILE_INTERACTIVE,  /* Small messages, latency with loss as retransmit delay */
+    ROUTE_PROFILE_BULK,         /* Time to push a chunk through the link */
+    ROUTE_PROFILE_CONTROL,      /* Reliability first, then fewer hops */
+    ROUTE_PROFILE_MAX
+} RouteProfile;
+
+#define ROUTE_LOSS_MAX              0.9f    /* Loss ratio clamp, keeps costs finite */
+#define ROUTE_BANDWIDTH_UNKNOWN     10      /* Mbps assumed for links not measured yet */
+#define ROUTE_BULK_CHUNK_KBIT       8192    /* 1 MiB, kbit / Mbps = ms */
+#define ROUTE_INTERACTIVE_RTO_MS    200.0f  /* Delay charged for a lost message */
+#define ROUTE_CONTROL_LOSS_MS       1000.0f /* Per unit loss ratio */
+#define ROUTE_CONTROL_HOP_MS        5.0f    /* Per hop */
+
+/* Custom cost of CSR edge e, must be >= 0 */
+typedef float (*RouteCostFn)(const GraphSnapshot *snap, int e, void *arg);
+
+static inline float route_loss_ratio(const GraphSnapshot *snap, int e) {
+    float loss = snap->packet_loss[e] / 100.0f;
+    return loss < 0 ? 0 : MIN(loss, ROUTE_LOSS_MAX);
+}
+
+static inline float route_cost_latency(const GraphSnapshot *snap, int e) {
+    return snap->latency[e];
+}
+
+static inline float route_cost_interactive(const GraphSnapshot *snap, int e) {
+    return snap->latency[e] + route_loss_ratio(snap, e) * ROUTE_INTERACTIVE_RTO_MS;
+}
+
+// 传输时间按期望重传次数放大
+static inline float route_cost_bulk(const GraphSnapshot *snap, int e) {
+    unsigned int bandwidth = snap->bandwidth[e] ? snap->bandwidth[e] : ROUTE_BANDWIDTH_UNKNOWN;
+    float transfer = snap->latency[e] + (float)ROUTE_BULK_CHUNK_KBIT / bandwidth;
+    return transfer / (1.0f - route_loss_ratio(snap, e));
+}
+
+static inline float route_cost_control(const GraphSnapshot *snap, int e) {
+    return snap->latency[e] + route_loss_ratio(snap, e) * ROUTE_CONTROL_LOSS_MS + ROUTE_CONTROL_HOP_MS;
+}
+
+/* With a constant profile the switch folds away */
+static inline ATTR_ALWAYS_INLINE float route_cost(const GraphSnapshot *snap, int e, RouteProfile profile) {
+    switch (profile) {
+        case ROUTE_PROFILE_INTERACTIVE: return route_cost_interactive(snap, e);
+        case ROUTE_PROFILE_BULK:        return route_cost_bulk(snap, e);
+        case ROUTE_PROFILE_CONTROL:     return route_cost_control(snap, e);
+        default:                        return route_cost_latency(snap, e);
+    }
+}
+
+#endif /* __COST_H__ */
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file expiry.h
+ * @brief Timeouts for nodes and edges that stop sending heartbeats.
+ *
+ * Every tracked node and edge owns a timer on a hierarchical wheel. A
+ * heartbeat only re-arms its timer. Timers that fire queue a removal, and
+ * all removals of one advance are applied to the graph as a single batch,
+ * so readers see one new version per sweep however many peers left. The
+ * wheel also hosts unrelated timers such as discovery status timeouts;
+ * their callbacks receive the GraphExpiry as argument.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __EXPIRY_H__
+#define __EXPIRY_H__
+
+#include "discovery/graph.h"
+#include "discovery/batch.h"
+#include "util/timer.h"
+
+#define GRAPH_EXPIRY_TICK_MS 100
+
+/* Timer of one node (to_id is GRAPH_INVALID_ID) or edge */
+typedef struct ExpiryRecord_ {
+    TimerEntry timer;
+    int from_id;
+    int to_id;
+} ExpiryRecord;
+
+typedef struct GraphExpiry_ {
+    TimerWheel wheel;
+    Graph *graph;
+    ExpiryRecord **table;         /* Open addressing on (from_id, to_id) */
+    unsigned int mask;
+    int count;
+    MemPool pool;                 /* ExpiryRecord objects */
+    unsigned int node_timeout_ms;
+    unsigned int edge_timeout_ms;
+    GraphBatch departed;          /* Filled by firing timers, applied after the wheel advanced */
+} GraphExpiry;
+
+/* Function */
+
+GraphExpiry* GraphExpiryCreate(Graph *graph, unsigned int node_timeout_ms, unsigned int edge_timeout_ms,
+                               uint64_t now_ms);
+void GraphExpiryDestroy(GraphExpiry *expiry);
+
+bool GraphExpiryTouchNode(GraphExpiry *expiry, int node_id, uint64_t now_ms);
+bool GraphExpiryTouchEdge(GraphExpiry *expiry, int from_id, int to_id, uint64_t now_ms);
+void GraphExpiryForgetNode(GraphExpiry *expiry, int node_id);
+void GraphExpiryForgetEdge(GraphExpiry *expiry, int from_id, int to_id);
+
+int GraphExpiryAdvance(GraphExpiry *expiry, uint64_t now_ms);
+
+#endif /* __EXPIRY_H__ */
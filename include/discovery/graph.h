@@ -26,6 +26,7 @@
 #define __GRAPH_H__
 
 #include "util/memory.h"
+#include "util/intern.h"
 
 /* Platform */
 typedef enum {
@@ -66,7 +67,7 @@ typedef struct IPAddress_ {
 } IPAddress;
 
 typedef struct NetworkInterface_ {
-    char name[128];     /* Interface */
+    StrId name;         /* Interface */
     IPAddress ip;       /* IP */
     char mac[18];       /* MAC */
     unsigned int mtu;   /* MTU */
@@ -76,9 +77,9 @@ typedef struct NetworkInterface_ {
 typedef struct Device_ {
     Platform platform;        /* Platform */
     SubPlatType subplatform;  /* Sub-Platform */
-    char hostname[128];       /* Hostname */
-    char os_version[32];      /* OS Version */
-    char architecture[16];    /* Architecture */
+    StrId hostname;           /* Hostname */
+    StrId os_version;         /* OS Version */
+    StrId architecture;       /* Architecture */
     unsigned long memory;     /* Memory total */
     unsigned long storage;    /* Storage total */
     IPAddress public_ip;      /* Public IP */
@@ -89,6 +90,15 @@ typedef struct Device_ {
     void *data;
 } Device;
 
+/* Node filter, zero fields match anything */
+typedef struct DeviceFilter_ {
+    Platform platform;
+    SubPlatType subplatform;
+    StrId hostname;
+    StrId os_version;
+    StrId architecture;
+} DeviceFilter;
+
 /* Edge */
 typedef struct EdgeData_ {
     char utilize;
@@ -101,35 +111,107 @@ typedef struct EdgeData_ {
     void *data;
 } EdgeData;
 
-/* Node */
+#define GRAPH_INVALID_ID   0
+#define GRAPH_INVALID_SLOT -1
+
+/* Adjacency record, stored inline in the owning node */
+typedef struct GraphEdge_ {
+    int slot;                     /* Neighbor slot */
+    int metric;                   /* Sample lane, EDGE_METRIC_NONE until first sampled */
+    EdgeData data;
+} GraphEdge;
+
+/* Node flags */
+#define NODE_FLAG_LOCAL BIT_U32(0)  /* The device we are running on */
+#define NODE_FLAG_STALE BIT_U32(1)  /* Restored from disk, not yet confirmed by a heartbeat */
+
+/* Node, traversal fields only. The slot doubles as the handle into Graph.devices */
 typedef struct GraphNode_ {
     int id;
-    Device data;
-    struct GraphNode **neighbors;
-    struct EdgeData **edge_data;
+    int slot;                     /* Dense slot, stable while the node lives */
+    unsigned int flags;
     int neighbor_count;
     int capacity;
+    GraphEdge *edges;             /* Contiguous adjacency, may move on growth */
+    int *in_slots;                /* Slots with an edge to this node, directed graphs only */
+    int in_count;
+    int in_capacity;
     // TODO: LAN IDS
-} GraphNode;
+} ATTR_ALIGNED(CLS) GraphNode;
+
+/* Id index entry */
+typedef struct GraphIndexEntry_ {
+    int id;                       /* GRAPH_INVALID_ID when empty */
+    int slot;
+} GraphIndexEntry;
+
+/* Id -> slot index (open addressing, linear probing, backward-shift delete) */
+typedef struct GraphIndex_ {
+    GraphIndexEntry *entries;
+    unsigned int mask;            /* Capacity - 1 */
+    int count;
+} GraphIndex;
+
+struct GraphSnapshot_;
+struct GraphJournal_;
+struct EdgeMetrics_;
+
+#define GRAPH_EDGE_MIN_CAPACITY 4
+#define GRAPH_EDGE_CLASSES      4   /* Pooled adjacency capacities: 4, 8, 16, 32 */
 
 /* Graph */
 typedef struct {
-    GraphNode **nodes;
-    int node_count;
+    GraphNode **nodes;            /* Indexed by slot, NULL when free */
+    Device *devices;              /* Cold descriptive data, indexed by slot */
+    int node_count;               /* Live nodes */
+    int slot_count;               /* Slots handed out so far */
     int capacity;
+    int *free_slots;              /* Released slots, reused LIFO */
+    int free_count;
+    GraphIndex index;
     bool directed;
+    int next_id;                  /* Next id handed out by GraphAddNode */
+    MemPool node_pool;            /* GraphNode objects, cache-line aligned */
+    MemPool edge_pools[GRAPH_EDGE_CLASSES];
+    unsigned long version;        /* Bumped on every topology change */
+    int update_depth;             /* Open GraphBeginUpdate calls */
+    bool update_dirty;            /* Something changed since the outermost GraphBeginUpdate */
+    struct GraphSnapshot_ *snapshot; /* Cached read-only view, see snapshot.h */
+    struct GraphJournal_ *journal;   /* Change log, NULL unless enabled, see journal.h */
+    struct EdgeMetrics_ *metrics;    /* Edge samples, created on first sample, see metrics.h */
 } Graph;
 
 /* Function */
 
 Graph* GraphCreate(bool directed);
 void GraphDestroy(Graph *graph);
+bool GraphEnableJournal(Graph *graph, int capacity);
+void GraphBeginUpdate(Graph *graph);
+void GraphEndUpdate(Graph *graph);
 
 GraphNode* GraphAddNode(Graph *graph, Device data);
+GraphNode* GraphAddNodeWithId(Graph *graph, int node_id, Device data);
+bool GraphUpdateNode(Graph *graph, int node_id, Device data);
+bool GraphReserve(Graph *graph, int count);
 bool GraphRemoveNode(Graph *graph, int node_id);
+int GraphRemoveStale(Graph *graph);
 GraphNode* GraphGetNode(Graph *graph, int node_id);
+int GraphGetSlot(Graph *graph, int node_id);
+int GraphIndexFind(const GraphIndex *index, int id);
+
+static inline GraphNode* GraphNodeAt(Graph *graph, int slot) {
+    return (slot >= 0 && slot < graph->slot_count) ? graph->nodes[slot] : NULL;
+}
+
+/* Valid until the next GraphAddNode */
+static inline Device* GraphNodeDevice(Graph *graph, const GraphNode *node) {
+    return &graph->devices[node->slot];
+}
+Device* GraphGetDevice(Graph *graph, int node_id);
+int GraphFilterNodes(Graph *graph, const DeviceFilter *filter, int *ids, int max);
 
 bool GraphAddEdge(Graph *graph, int from_id, int to_id, EdgeData data);
+bool GraphReserveEdges(Graph *graph, int node_id, int count);
 bool GraphRemoveEdge(Graph *graph, int from_id, int to_id);
 EdgeData* GraphGetEdge(Graph *graph, int from_id, int to_id);
 
@@ -137,7 +219,9 @@ void GraphDFS(Graph *graph, int start_id, void (*visit)(GraphNode*));
 void GraphBFS(Graph *graph, int start_id, void (*visit)(GraphNode*));
 int GraphShortestPath(Graph *graph, int start_id, int end_id, int **path);
 
-void NodeInit(Device *data, Platform platform, SubPlatType subplatform);
+void NodeInit(Device *data, Platform platform, SubPlatType subplatform,
+              const char *hostname, const char *os_version, const char *architecture);
+void NodeRelease(Device *data);
 void NodeAddInterface(Device *data, const char *name, const char *ip_v4, const char *ip_v6, 
                        const char *mac, unsigned int mtu);
 void NodeSetPublicIp(Device *data, const char *ip_v4, const char *ip_v6);
@@ -145,7 +229,7 @@ void NodeSetPrivateIp(Device *data, const char *ip_v4, const char *ip_v6);
 
 const char* PlatformToString(Platform platform);
 const char* SubPlatformToString(SubPlatType subplatform);
-void PrintNodeInfo(GraphNode *node);
+void PrintNodeInfo(Graph *graph, GraphNode *node);
 void PrintEdgeInfo(Graph *graph, int from_id, int to_id);
 
 
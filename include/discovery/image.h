@@ -0,0 +1,117 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file image.h
+ * @brief On-disk topology image for warm restart.
+ *
+ * The image is a single checksummed file of fixed-size tables addressed by
+ * offset, so it can be mmap'ed anywhere and validated without parsing.
+ * It is written to a temporary file and renamed into place, so readers see
+ * either the old image or the new one. Byte order and layout are those of
+ * the host that wrote it.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __IMAGE_H__
+#define __IMAGE_H__
+
+#include "discovery/graph.h"
+
+#define GRAPH_IMAGE_MAGIC  0x4f50544cU   /* "LTPO" */
+#define GRAPH_IMAGE_FORMAT 1
+#define GRAPH_IMAGE_ENDIAN 0x01020304U   /* Rejects images from the other byte order */
+
+typedef struct GraphImageHeader_ {
+    uint32_t magic;
+    uint32_t format;
+    uint32_t endian;
+    uint32_t checksum;          /* CRC-32 of everything after the header */
+    uint64_t size;              /* Whole file */
+    uint64_t version;           /* Graph version saved */
+    int64_t saved_at;
+    uint32_t directed;
+    uint32_t node_count;
+    uint32_t iface_count;
+    uint32_t edge_count;
+    uint64_t node_offset;
+    uint64_t iface_offset;
+    uint64_t edge_offset;
+} GraphImageHeader;
+
+typedef struct GraphImageNode_ {
+    int32_t id;
+    uint32_t flags;
+    int32_t platform;
+    int32_t subplatform;
+    char hostname[128];
+    char os_version[32];
+    char architecture[16];
+    uint64_t memory;
+    uint64_t storage;
+    IPAddress public_ip;
+    IPAddress private_ip;
+    uint32_t iface_first;       /* Index into the interface table */
+    uint32_t iface_count;
+    int32_t iface_used;         /* Relative to iface_first, -1 for none */
+    uint32_t edge_first;        /* Index into the edge table */
+    uint32_t edge_count;
+} GraphImageNode;
+
+typedef struct GraphImageIface_ {
+    char name[128];
+    IPAddress ip;
+    char mac[18];
+    uint32_t mtu;
+} GraphImageIface;
+
+typedef struct GraphImageEdge_ {
+    uint32_t to;                /* Index into the node table */
+    uint32_t bandwidth;
+    float latency;
+    float packet_loss;
+    uint64_t traffic;
+    int64_t last_communication;
+    uint16_t port;
+    char utilize;
+} GraphImageEdge;
+
+/* Mapped, validated image */
+typedef struct GraphImage_ {
+    void *map;
+    size_t size;
+    const GraphImageHeader *header;
+    const GraphImageNode *nodes;
+    const GraphImageIface *ifaces;
+    const GraphImageEdge *edges;
+} GraphImage;
+
+/* Function */
+
+void* GraphImageEncode(Graph *graph, size_t *size);
+bool GraphImageWrite(const void *buf, size_t size, const char *path);
+bool GraphImageSave(Graph *graph, const char *path);
+bool GraphImageSaveAsync(Graph *graph, const char *path);
+
+GraphImage* GraphImageOpen(const char *path);
+void GraphImageClose(GraphImage *image);
+Graph* GraphImageRestore(const GraphImage *image);
+
+#endif /* __IMAGE_H__ */
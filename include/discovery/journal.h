@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file journal.h
+ * @brief Bounded append-only log of topology changes, keyed by graph version.
+ *
+ * The writer appends one delta per node or edge change, stamped with the
+ * graph version that contains it. A batch shares one version. Subscribers
+ * seek to the first delta after the version they last saw and read forward
+ * with a sequence cursor, without taking the writer lock. When the ring has
+ * wrapped past a subscriber it must resync from a full snapshot.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __JOURNAL_H__
+#define __JOURNAL_H__
+
+#include "discovery/graph.h"
+
+#define GRAPH_JOURNAL_GAP (~0UL)   /* Returned by seek when deltas were overwritten */
+
+/* Change type */
+typedef enum {
+    GRAPH_DELTA_NODE_ADD = 0,
+    GRAPH_DELTA_NODE_UPDATE,
+    GRAPH_DELTA_NODE_REMOVE,    /* Implies removal of every edge of the node */
+    GRAPH_DELTA_EDGE_ADD,
+    GRAPH_DELTA_EDGE_UPDATE,
+    GRAPH_DELTA_EDGE_REMOVE,
+    GRAPH_DELTA_MAX
+} GraphDeltaType;
+
+typedef struct GraphDelta_ {
+    unsigned long version;      /* Graph version after the change */
+    GraphDeltaType type;
+    int from_id;                /* Node id for node changes */
+    int to_id;                  /* GRAPH_INVALID_ID for node changes */
+    EdgeData edge;              /* Edge add and update only */
+} GraphDelta;
+
+/* Ring of deltas. Sequence numbers count every delta ever appended */
+typedef struct GraphJournal_ {
+    GraphDelta *entries;
+    unsigned long mask;         /* Capacity - 1 */
+    unsigned long head;         /* Sequence of the next delta, published with release */
+    unsigned long reserved;     /* Sequence being written, ahead of head while writing */
+    unsigned long lost_version; /* Newest version with an overwritten delta */
+} GraphJournal;
+
+/* Function */
+
+GraphJournal* GraphJournalCreate(int capacity);
+void GraphJournalDestroy(GraphJournal *journal);
+
+void GraphJournalAppend(GraphJournal *journal, unsigned long version, GraphDeltaType type,
+                        int from_id, int to_id, const EdgeData *edge);
+
+unsigned long GraphJournalSeek(const GraphJournal *journal, unsigned long since_version);
+int GraphJournalRead(const GraphJournal *journal, unsigned long *seq, GraphDelta *out, int max);
+
+const char* GraphDeltaTypeToString(GraphDeltaType type);
+
+#endif /* __JOURNAL_H__ */
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file landmark.h
+ * @brief Landmark distance tables for A* (ALT) point-to-point search.
+ *
+ * A handful of landmarks is picked by farthest-point selection, then one
+ * full shortest-path tree is run from and to each of them. By the triangle
+ * inequality d(L, t) - d(L, v) and d(v, L) - d(t, L) are lower bounds on
+ * d(v, t), which steer the search towards the target. The bounds only hold
+ * for the snapshot version the table was built from. Directed tables also
+ * carry the transposed snapshot used by the backward searches.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __LANDMARK_H__
+#define __LANDMARK_H__
+
+#include <float.h>
+
+#include "discovery/router.h"
+
+#define LANDMARK_DEFAULT_COUNT 8
+#define LANDMARK_MAX_COUNT     32
+
+struct LandmarkTable_ {
+    unsigned long version;      /* Snapshot version it was built from */
+    int slot_count;
+    int count;
+    int *landmarks;             /* Landmark slots */
+    float *from;                /* Row per landmark, d(landmark, slot), FLT_MAX when unreachable */
+    float *to;                  /* d(slot, landmark), same buffer as from when undirected */
+    GraphSnapshot *reverse;     /* Transposed snapshot, NULL when undirected */
+};
+
+/* Function */
+
+LandmarkTable* landmark_table_build(const GraphSnapshot *snap, int count);
+void landmark_table_destroy(LandmarkTable *table);
+
+/* Lower bound on d(slot, target_slot) */
+static inline float landmark_bound(const LandmarkTable *table, int slot, int target_slot) {
+    float bound = 0;
+    for (int i = 0; i < table->count; i++) {
+        const float *from = table->from + (size_t)i * table->slot_count;
+        const float *to = table->to + (size_t)i * table->slot_count;
+        if (from[target_slot] != FLT_MAX && from[slot] != FLT_MAX) {
+            bound = MAX(bound, from[target_slot] - from[slot]);
+        }
+        if (to[slot] != FLT_MAX && to[target_slot] != FLT_MAX) {
+            bound = MAX(bound, to[slot] - to[target_slot]);
+        }
+    }
+    return bound;
+}
+
+#endif /* __LANDMARK_H__ */
@@ -0,0 +1,105 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file metrics.h
+ * @brief Per-edge sample rings and smoothed link metrics.
+ *
+ * Each sampled edge owns a lane. A lane keeps the last EDGE_METRIC_SAMPLES
+ * probes for percentiles and accumulates new probes until the next
+ * aggregation, which folds them into an EWMA for every lane in one
+ * vectorized pass. Routing reads the smoothed values, so a single noisy
+ * probe no longer flips a route.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include "discovery/graph.h"
+
+#define EDGE_METRIC_NONE    -1
+#define EDGE_METRIC_SAMPLES 16      /* Ring length per lane */
+#define EDGE_METRIC_ALPHA   0.2f    /* Weight of a new aggregate in the EWMA */
+#define EDGE_METRIC_LANES   8       /* Lane capacity granularity, one AVX register */
+
+/* Lane storage, structure of arrays indexed by lane */
+typedef struct EdgeMetrics_ {
+    int capacity;
+    int count;                  /* Lanes handed out so far */
+    int *free_lanes;
+    int free_count;
+    float alpha;
+    /* Sample rings, EDGE_METRIC_SAMPLES entries per lane */
+    float *latency_ring;
+    float *loss_ring;
+    float *bandwidth_ring;
+    uint8_t *ring_head;
+    uint8_t *ring_fill;
+    /* Accumulated since the last aggregation */
+    float *latency_sum;
+    float *loss_sum;
+    float *bandwidth_sum;
+    float *pending;             /* Sample count */
+    /* Smoothed values */
+    float *latency;
+    float *loss;
+    float *bandwidth;
+    float *primed;              /* 1 once the lane has been aggregated */
+} EdgeMetrics;
+
+typedef struct EdgeStats_ {
+    float latency;              /* EWMA */
+    float packet_loss;
+    float bandwidth;
+    float latency_p50;
+    float latency_p99;
+    float loss_p50;
+    float loss_p99;
+    int samples;                /* Samples in the ring */
+} EdgeStats;
+
+/* Function */
+
+EdgeMetrics* EdgeMetricsCreate(float alpha);
+void EdgeMetricsDestroy(EdgeMetrics *metrics);
+
+int EdgeMetricsAcquire(EdgeMetrics *metrics);
+void EdgeMetricsRelease(EdgeMetrics *metrics, int lane);
+void EdgeMetricsRecord(EdgeMetrics *metrics, int lane, float latency, float packet_loss, float bandwidth);
+int EdgeMetricsAggregate(EdgeMetrics *metrics);
+void EdgeMetricsStats(const EdgeMetrics *metrics, int lane, EdgeStats *stats);
+
+static inline bool EdgeMetricsReady(const EdgeMetrics *metrics, int lane) {
+    return metrics && lane >= 0 && metrics->primed[lane] != 0.0f;
+}
+
+/* Latency routing uses for an edge: smoothed once aggregated, the raw value before */
+static inline float GraphEdgeLatency(const Graph *graph, const GraphEdge *edge) {
+    return EdgeMetricsReady(graph->metrics, edge->metric) ? graph->metrics->latency[edge->metric]
+                                                           : edge->data.latency;
+}
+
+bool GraphEdgeSample(Graph *graph, int from_id, int to_id, float latency, float packet_loss,
+                     unsigned int bandwidth);
+int GraphAggregateMetrics(Graph *graph);
+bool GraphGetEdgeStats(Graph *graph, int from_id, int to_id, EdgeStats *stats);
+
+#endif /* __METRICS_H__ */
@@ -0,0 +1,78 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file nexthop.h
+ * @brief All-pairs next-hop table for the relay forwarding plane.
+ *
+ * Built from a snapshot by running a full shortest-path tree from every
+ * source, sources spread over a pool of threads. Row src holds, for every
+ * destination slot, the slot of the first hop on the shortest path, so
+ * forwarding a packet is a single array read. Entries are uint16 while the
+ * slot count allows it, uint32 otherwise. Tables are immutable once built.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __NEXTHOP_H__
+#define __NEXTHOP_H__
+
+#include "discovery/router.h"
+
+#define NEXT_HOP_NONE16    UINT16_MAX
+#define NEXT_HOP_NONE32    UINT32_MAX
+#define NEXT_HOP_MAX_SLOTS 65535        /* Beyond this rows are uint32 */
+
+typedef struct NextHopTable_ {
+    unsigned long version;      /* Snapshot version it was built from */
+    int slot_count;
+    bool wide;
+    union {
+        uint16_t *hops16;       /* slot_count * slot_count, row per source */
+        uint32_t *hops32;
+    };
+    int *ids;                   /* Slot -> node id */
+    GraphIndex index;           /* Id -> slot */
+} NextHopTable;
+
+/* Function */
+
+NextHopTable* next_hop_table_build(const GraphSnapshot *snap, int threads);
+void next_hop_table_destroy(NextHopTable *table);
+
+/* Slot of the next hop from src_slot towards dst_slot, GRAPH_INVALID_SLOT when unreachable */
+static inline int next_hop_slot(const NextHopTable *table, int src_slot, int dst_slot) {
+    size_t i = (size_t)src_slot * table->slot_count + dst_slot;
+    if (table->wide) {
+        return table->hops32[i] == NEXT_HOP_NONE32 ? GRAPH_INVALID_SLOT : (int)table->hops32[i];
+    }
+    return table->hops16[i] == NEXT_HOP_NONE16 ? GRAPH_INVALID_SLOT : (int)table->hops16[i];
+}
+
+/* Node id of the next hop, GRAPH_INVALID_ID when unknown or unreachable */
+static inline int next_hop_lookup(const NextHopTable *table, int src_id, int dst_id) {
+    int src = GraphIndexFind(&table->index, src_id);
+    int dst = GraphIndexFind(&table->index, dst_id);
+    if (src == GRAPH_INVALID_SLOT || dst == GRAPH_INVALID_SLOT) return GRAPH_INVALID_ID;
+
+    int hop = next_hop_slot(table, src, dst);
+    return hop == GRAPH_INVALID_SLOT ? GRAPH_INVALID_ID : table->ids[hop];
+}
+
+#endif /* __NEXTHOP_H__ */
@@ -0,0 +1,94 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file path_set.h
+ * @brief Result set of paths packed into one id buffer.
+ *
+ * Node ids of every path sit back to back in node_ids, path i spans
+ * [offsets[i], offsets[i + 1]). A set owns three buffers no matter how many
+ * paths it holds, and path_set_reset() keeps them for the next query, so a
+ * reused set stops allocating once it has grown to the working size.
+ * Paths handed out by the iterator are views into the set and stay valid
+ * until the set is reset, grown or destroyed.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __PATH_SET_H__
+#define __PATH_SET_H__
+
+#include "discovery/router.h"
+
+#define PATH_SET_MIN_PATHS 8
+#define PATH_SET_MIN_IDS   64
+
+/* Typedef lives in router.h so the batched queries can take a PathSet */
+struct PathSet_ {
+    int *node_ids;      /* All paths, back to back */
+    int *offsets;       /* count + 1 entries */
+    float *costs;       /* Per path total cost */
+    int count;
+    int path_capacity;
+    int id_capacity;
+};
+
+typedef struct PathSetIter_ {
+    const PathSet *set;
+    int index;
+} PathSetIter;
+
+/* Function */
+
+PathSet* path_set_create(int paths, int ids);
+void path_set_destroy(PathSet *set);
+void path_set_reset(PathSet *set);
+bool path_set_reserve(PathSet *set, int paths, int ids);
+int path_set_add(PathSet *set, const int *node_ids, int length, float total_cost);
+void path_set_print(const PathSet *set, Graph *graph);
+
+static inline int path_set_count(const PathSet *set) {
+    return set->count;
+}
+
+static inline int path_set_length(const PathSet *set, int index) {
+    return set->offsets[index + 1] - set->offsets[index];
+}
+
+/* View of path index, empty (length 0) for a query that found no route */
+static inline Path path_set_get(const PathSet *set, int index) {
+    Path path;
+    path.node_ids = set->node_ids + set->offsets[index];
+    path.length = path_set_length(set, index);
+    path.total_cost = set->costs[index];
+    return path;
+}
+
+static inline void path_set_iter_init(PathSetIter *iter, const PathSet *set) {
+    iter->set = set;
+    iter->index = 0;
+}
+
+static inline bool path_set_next(PathSetIter *iter, Path *path) {
+    if (iter->index >= iter->set->count) return false;
+    *path = path_set_get(iter->set, iter->index++);
+    return true;
+}
+
+#endif /* __PATH_SET_H__ */
@@ -0,0 +1,79 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file route_cache.h
+ * @brief Bounded cache of computed routes keyed by (src, dst).
+ *
+ * Every entry is tagged with the snapshot version it was computed on. A
+ * lookup against a newer snapshot first replays the journal since that
+ * version: changes that cannot make the route shorter or longer (node
+ * updates, removals off the route) keep the entry, anything else drops it.
+ * Without a journal, or when it has wrapped, any version change is a miss.
+ * Eviction is CLOCK. A cache is not locked, use one per thread.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __ROUTE_CACHE_H__
+#define __ROUTE_CACHE_H__
+
+#include "discovery/router.h"
+#include "discovery/journal.h"
+
+#define ROUTE_CACHE_MIN_CAPACITY 16
+#define ROUTE_CACHE_MAX_REPLAY   64     /* Deltas replayed per lookup before giving up */
+
+typedef struct RouteCacheEntry_ {
+    int src;
+    int dst;                    /* GRAPH_INVALID_ID when the entry is free */
+    unsigned long version;      /* Newest version the route is known to hold for */
+    Path *path;                 /* NULL for a cached "unreachable" */
+    bool referenced;            /* CLOCK bit */
+} RouteCacheEntry;
+
+typedef struct RouteCacheStats_ {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long revalidated;  /* Hits that replayed the journal */
+    unsigned long invalidated;  /* Entries dropped for a topology change */
+    unsigned long evictions;
+} RouteCacheStats;
+
+typedef struct RouteCache_ {
+    RouteCacheEntry *entries;
+    int capacity;
+    int count;
+    int hand;                   /* CLOCK hand */
+    int *index;                 /* Open addressing on (src, dst) -> entry, -1 when empty */
+    unsigned int index_mask;
+    RouteCacheStats stats;
+} RouteCache;
+
+/* Function */
+
+RouteCache* route_cache_create(int capacity);
+void route_cache_destroy(RouteCache *cache);
+void route_cache_clear(RouteCache *cache);
+
+const Path* route_cache_get(RouteCache *cache, const GraphSnapshot *snap, const GraphJournal *journal,
+                            int src_id, int dst_id);
+void route_cache_print_stats(const RouteCache *cache);
+
+#endif /* __ROUTE_CACHE_H__ */
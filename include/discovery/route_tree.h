@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file route_tree.h
+ * @brief Single-source shortest-path tree in one flat allocation.
+ *
+ * One search from the source fills distances and predecessors for every
+ * slot. The tree copies the slot -> id map and the id index next to them,
+ * so it does not depend on the snapshot it was built from, and is freed
+ * with a single call. Extracting the path to any destination walks the
+ * predecessors, O(hops), into a buffer owned by the caller.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __ROUTE_TREE_H__
+#define __ROUTE_TREE_H__
+
+#include <float.h>
+
+#include "discovery/router.h"
+
+typedef struct RouteTree_ {
+    unsigned long version;      /* Snapshot version it was built from */
+    RouteProfile profile;
+    int source_slot;
+    int slot_count;
+    float *distances;           /* FLT_MAX when unreachable */
+    int *previous;              /* Parent slot, -1 for the source and unreachable slots */
+    int *ids;                   /* Slot -> node id */
+    GraphIndex index;           /* Id -> slot */
+} RouteTree;
+
+/* Function */
+
+RouteTree* snapshot_route_tree(const GraphSnapshot *snap, int source_id, RouteProfile profile);
+RouteTree* graph_route_tree(Graph *graph, int source_id, RouteProfile profile);
+void route_tree_destroy(RouteTree *tree);
+
+int route_tree_path(const RouteTree *tree, int dst_id, int *node_ids, int capacity);
+int route_tree_first_hop(const RouteTree *tree, int dst_id);
+
+/* Cost to dst_id in profile units, FLT_MAX when unreachable or unknown */
+static inline float route_tree_distance(const RouteTree *tree, int dst_id) {
+    int slot = GraphIndexFind(&tree->index, dst_id);
+    return slot == GRAPH_INVALID_SLOT ? FLT_MAX : tree->distances[slot];
+}
+
+#endif /* __ROUTE_TREE_H__ */
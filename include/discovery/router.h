@@ -25,8 +25,12 @@
 #ifndef __ROUTER_H__
 #define __ROUTER_H__
 
+#include <float.h>
+
 #include "util/memory.h"
 #include "discovery/graph.h"
+#include "discovery/snapshot.h"
+#include "discovery/cost.h"
 
 // 路径结构 - 只存储节点ID
 typedef struct {
@@ -56,4 +60,64 @@ typedef struct {
     int count;
 } PathList;
 
+// 连续存放的路径结果集，见 discovery/path_set.h
+typedef struct PathSet_ PathSet;
+
+// 地标距离表，见 discovery/landmark.h
+typedef struct LandmarkTable_ LandmarkTable;
+
+// 函数
+
+MemArena* router_scratch(void);
+void router_print_stats(void);
+
+Path* path_create(int *node_ids, int length, float total_cost);
+void path_destroy(Path *path);
+PathWithEdges* path_with_edges_create(GraphNode **nodes, EdgeData **edges, int length, float total_cost);
+void path_with_edges_destroy(PathWithEdges *path);
+
+PathList* path_list_create();
+void path_list_add(PathList *list, Path *path);
+void path_list_remove(PathList *list, Path *path);
+void path_list_destroy(PathList *list);
+
+void path_print(Path *path, Graph *graph);
+void path_with_edges_print(PathWithEdges *path, Graph *graph);
+
+Path* graph_find_shortest_path(Graph *graph, int start_id, int end_id);
+Path* snapshot_find_shortest_path(const GraphSnapshot *snap, int start_id, int end_id);
+PathList* graph_find_k_shortest_paths(Graph *graph, int start_id, int end_id, int max_paths, bool edge_disjoint);
+PathList* snapshot_find_k_shortest_paths(const GraphSnapshot *snap, int start_id, int end_id, int max_paths,
+                                         bool edge_disjoint);
+int snapshot_find_k_shortest_paths_into(const GraphSnapshot *snap, int start_id, int end_id, int max_paths,
+                                        bool edge_disjoint, PathSet *out);
+bool snapshot_dijkstra(const GraphSnapshot *snap, int start_slot, int end_slot, MemArena *scratch,
+                       float *distances, int *previous);
+
+// 按流量类型选路，total_cost 为该类型的成本单位
+Path* graph_find_route(Graph *graph, int start_id, int end_id, RouteProfile profile);
+Path* snapshot_find_route(const GraphSnapshot *snap, int start_id, int end_id, RouteProfile profile);
+Path* snapshot_find_route_custom(const GraphSnapshot *snap, int start_id, int end_id, RouteCostFn cost, void *arg);
+bool snapshot_dijkstra_profile(const GraphSnapshot *snap, RouteProfile profile, int start_slot, int end_slot,
+                               MemArena *scratch, float *distances, int *previous);
+bool snapshot_dijkstra_custom(const GraphSnapshot *snap, RouteCostFn cost, void *arg, int start_slot, int end_slot,
+                              MemArena *scratch, float *distances, int *previous);
+// 批量选路，结果依次追加到 out，返回可达的条数，失败返回 -1
+int snapshot_find_routes(const GraphSnapshot *snap, const int *src_ids, const int *dst_ids, int count,
+                         RouteProfile profile, PathSet *out);
+
+// 点对点最短延迟路径，settled 可为 NULL，返回出堆的节点数
+// landmarks 为 NULL 时即普通 Dijkstra，可作为对照
+Path* snapshot_find_path_bidirectional(const GraphSnapshot *snap, const GraphSnapshot *reverse, int start_id,
+                                       int end_id, int *settled);
+Path* snapshot_find_path_alt(const GraphSnapshot *snap, const LandmarkTable *landmarks, int start_id, int end_id,
+                             int *settled);
+
+// 最宽路径：瓶颈带宽最大，瓶颈相同时延迟最短，total_cost 为总延迟
+PathWithEdges* graph_find_widest_path(Graph *graph, int start_id, int end_id);
+// 单源瓶颈带宽（Mbps），按槽位索引，调用者 FREE_S；源为 UINT_MAX，不可达或未测量为 0
+unsigned int* snapshot_bottlenecks(const GraphSnapshot *snap, int source_id);
+bool snapshot_widest_tree(const GraphSnapshot *snap, int start_slot, MemArena *scratch,
+                          unsigned int *widths, int *previous);
+
 #endif /* __ROUTER_H__ */
\ No newline at end of file
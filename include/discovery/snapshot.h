@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file snapshot.h
+ * @brief Immutable compressed-sparse-row view of a Graph for read-only queries.
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include "util/memory.h"
+#include "discovery/graph.h"
+
+#define SNAPSHOT_MAX_THREADS 64
+
+/* CSR snapshot, rows are graph slots */
+typedef struct GraphSnapshot_ {
+    unsigned long version;      /* Graph version it was built from */
+    bool directed;
+    int slot_count;             /* Rows */
+    int edge_count;
+    int *ids;                   /* Slot -> node id, GRAPH_INVALID_ID for holes */
+    int *offsets;               /* Row start, slot_count + 1 entries */
+    int *targets;               /* Neighbor slot per edge */
+    float *latency;             /* Ping（ms） */
+    float *packet_loss;         /* Loss（%） */
+    unsigned int *bandwidth;    /* Band（Mbps） */
+    GraphIndex index;           /* Id -> slot, copied from the graph */
+    int slot_capacity;
+    int edge_capacity;
+} GraphSnapshot;
+
+/* Function */
+
+GraphSnapshot* GraphSnapshotBuild(Graph *graph);
+bool GraphSnapshotRebuild(GraphSnapshot *snap, Graph *graph);
+void GraphSnapshotDestroy(GraphSnapshot *snap);
+GraphSnapshot* GraphSnapshotReverse(const GraphSnapshot *snap);
+
+GraphSnapshot* GraphGetSnapshot(Graph *graph);
+int GraphSnapshotGetSlot(const GraphSnapshot *snap, int node_id);
+
+void GraphSnapshotDFS(const GraphSnapshot *snap, int start_id, void (*visit)(int node_id));
+void GraphSnapshotBFS(const GraphSnapshot *snap, int start_id, void (*visit)(int node_id));
+int GraphSnapshotParallelBFS(const GraphSnapshot *snap, int start_id, int threads, int *levels);
+int GraphSnapshotComponents(const GraphSnapshot *snap, int threads, int *component);
+
+#endif /* __SNAPSHOT_H__ */
@@ -0,0 +1,72 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file sptree.h
+ * @brief Shortest-path tree from one node, repaired in place as the graph changes.
+ *
+ * Meant for the local node. The tree follows the live Graph through its
+ * journal: a cheaper edge relaxes outward from its head, a dearer or removed
+ * tree edge detaches the subtree below it and reattaches it through the
+ * best remaining in-edges. Node removals, journal gaps, versions without
+ * deltas (metric aggregation) and repairs that would touch too much of the
+ * graph fall back to a full Dijkstra. Weights match the routing snapshot.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __SPTREE_H__
+#define __SPTREE_H__
+
+#include <float.h>
+
+#include "discovery/router.h"
+#include "discovery/journal.h"
+
+#define SPTREE_MAX_DELTAS    256    /* Deltas repaired per sync before recomputing */
+#define SPTREE_MAX_AFFECTED  4      /* Recompute when a subtree exceeds 1/N of the slots */
+
+typedef struct ShortestPathTreeStats_ {
+    unsigned long repairs;      /* Syncs done incrementally */
+    unsigned long recomputes;
+    unsigned long touched;      /* Nodes whose distance a repair rewrote */
+} ShortestPathTreeStats;
+
+typedef struct ShortestPathTree_ {
+    int source_id;
+    unsigned long version;      /* Graph version the tree is exact for */
+    int capacity;               /* Slots covered by the arrays */
+    float *distances;           /* FLT_MAX when unreachable */
+    int *parents;               /* Parent slot, -1 for the source and unreachable slots */
+    float *parent_cost;         /* Weight of the parent edge when it was chosen */
+    ShortestPathTreeStats stats;
+} ShortestPathTree;
+
+/* Function */
+
+ShortestPathTree* sptree_create(Graph *graph, int source_id);
+void sptree_destroy(ShortestPathTree *tree);
+
+bool sptree_recompute(ShortestPathTree *tree, Graph *graph);
+bool sptree_sync(ShortestPathTree *tree, Graph *graph);
+
+float sptree_distance(const ShortestPathTree *tree, Graph *graph, int node_id);
+Path* sptree_path(const ShortestPathTree *tree, Graph *graph, int node_id);
+
+#endif /* __SPTREE_H__ */
@@ -0,0 +1,90 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file topology.h
+ * @brief Global device topology shared between discovery writers and routing readers.
+ *
+ * Writers serialize on a mutex, mutate g_dev_topology and publish a fresh
+ * GraphSnapshot with an atomic pointer swap. Readers pin the published
+ * snapshot by entering an epoch and never block. Retired snapshots are
+ * reclaimed once no reader that could still see them is active.
+ * A thread takes a reader slot on its first read section and gives it back
+ * on exit, so only more than TOPOLOGY_MAX_READERS concurrently live reader
+ * threads ever wait for a slot.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __TOPOLOGY_H__
+#define __TOPOLOGY_H__
+
+#include "discovery/graph.h"
+#include "discovery/snapshot.h"
+#include "discovery/journal.h"
+#include "discovery/image.h"
+#include "discovery/expiry.h"
+#include "discovery/nexthop.h"
+#include "discovery/landmark.h"
+#include "discovery/route_tree.h"
+
+#define TOPOLOGY_MAX_READERS 64
+#define TOPOLOGY_JOURNAL_CAPACITY 4096
+#define TOPOLOGY_NODE_TIMEOUT_MS  30000
+#define TOPOLOGY_EDGE_TIMEOUT_MS  15000
+
+/* Per-thread reader record, one cache line each */
+typedef struct TopologyReader_ {
+    unsigned long epoch;   /* Global epoch seen on entry */
+    int depth;             /* Nesting depth, 0 when outside a read section */
+    char in_use;
+} ATTR_ALIGNED(CLS) TopologyReader;
+
+/* Global */
+
+extern Graph* g_dev_topology;
+extern GraphNode* g_cur_dev;
+
+/* Function */
+
+bool topology_init(bool directed);
+bool topology_restore(const char *path);
+void topology_destroy(void);
+
+const GraphSnapshot* topology_read_begin(void);
+void topology_read_end(void);
+void topology_reader_unregister(void);
+
+Graph* topology_write_begin(void);
+void topology_write_end(void);
+void topology_synchronize(void);
+
+const GraphJournal* topology_journal(void);
+bool topology_save(const char *path);
+
+GraphExpiry* topology_expiry(void);
+int topology_expire(void);
+
+bool topology_routing_start(int threads);
+void topology_routing_stop(void);
+int topology_next_hop(int src_id, int dst_id);
+Path* topology_find_shortest_path(int src_id, int dst_id);
+RouteTree* topology_route_tree(int src_id, RouteProfile profile);
+
+#endif /* __TOPOLOGY_H__ */
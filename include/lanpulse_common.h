@@ -120,6 +120,10 @@
 #include <sched.h>     /* for sched_setaffinity(2) */
 #endif
 
+#if HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 #ifdef HAVE_TYPE_U_LONG_NOT_DEFINED
 typedef unsigned long int u_long;
 #endif
@@ -378,6 +382,18 @@ typedef unsigned char u_char;
 #define ATTR_FMT_PRINTF(x, y)
 #endif
 
+#if defined(__GNUC__)
+#define ATTR_ALIGNED(x) __attribute__((aligned(x)))
+#else
+#define ATTR_ALIGNED(x)
+#endif
+
+#if defined(__GNUC__)
+#define ATTR_ALWAYS_INLINE __attribute__((always_inline))
+#else
+#define ATTR_ALWAYS_INLINE
+#endif
+
 #include <ctype.h>
 #define u8_tolower(c) ((uint8_t)tolower((uint8_t)(c)))
 #define u8_toupper(c) ((uint8_t)toupper((uint8_t)(c)))
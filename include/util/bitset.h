@@ -0,0 +1,77 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file bitset.h
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __BITSET_H__
+#define __BITSET_H__
+
+#include "util/memory.h"
+
+#define BITSET_WORDS(nbits) (((size_t)(nbits) + 63) / 64)
+
+/* Dense bitset over slot indices, storage owned by the caller */
+typedef struct Bitset_ {
+    uint64_t *words;
+    int nbits;
+} Bitset;
+
+static inline bool bitset_init(Bitset *set, uint64_t *words, int nbits) {
+    set->words = words;
+    set->nbits = nbits;
+    if (!words) return false;
+    memset(words, 0, BITSET_WORDS(nbits) * sizeof(uint64_t));
+    return true;
+}
+
+static inline bool bitset_arena_init(Bitset *set, MemArena *arena, int nbits) {
+    return bitset_init(set, ARENA_ALLOC_S(arena, BITSET_WORDS(nbits), uint64_t), nbits);
+}
+
+static inline bool bitset_test(const Bitset *set, int bit) {
+    return (set->words[bit >> 6] >> (bit & 63)) & 1;
+}
+
+static inline void bitset_set(Bitset *set, int bit) {
+    set->words[bit >> 6] |= BIT_U64(bit & 63);
+}
+
+static inline void bitset_clear(Bitset *set, int bit) {
+    set->words[bit >> 6] &= ~BIT_U64(bit & 63);
+}
+
+/* Returns the previous value */
+static inline bool bitset_test_and_set(Bitset *set, int bit) {
+    uint64_t mask = BIT_U64(bit & 63);
+    uint64_t old = set->words[bit >> 6];
+    set->words[bit >> 6] = old | mask;
+    return old & mask;
+}
+
+/* Same as bitset_test_and_set, safe against concurrent setters */
+static inline bool bitset_atomic_test_and_set(Bitset *set, int bit) {
+    uint64_t mask = BIT_U64(bit & 63);
+    if (__atomic_load_n(&set->words[bit >> 6], __ATOMIC_RELAXED) & mask) return true;
+    return __atomic_fetch_or(&set->words[bit >> 6], mask, __ATOMIC_RELAXED) & mask;
+}
+
+#endif /* __BITSET_H__ */
@@ -0,0 +1,142 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file heap.h
+ * @brief Indexed d-ary min-heap over dense integer items, with decrease-key.
+ *
+ * Items are slot indices below the capacity given at init. pos[] maps an item
+ * to its heap position so a key can be lowered in place instead of pushing a
+ * duplicate. A wider node than binary halves the depth, and the children of a
+ * node share a cache line. Storage comes from the caller, usually an arena.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __HEAP_H__
+#define __HEAP_H__
+
+#include <float.h>
+
+#include "util/memory.h"
+
+#define HEAP_ARITY  4
+#define HEAP_NONE   -1      /* Never pushed */
+#define HEAP_POPPED -2      /* Pushed and popped */
+
+typedef struct HeapEntry_ {
+    float key;
+    int item;
+} HeapEntry;
+
+typedef struct IndexedHeap_ {
+    HeapEntry *entries;
+    int *pos;               /* Item -> position, or HEAP_NONE / HEAP_POPPED */
+    int count;
+} IndexedHeap;
+
+static inline bool heap_arena_init(IndexedHeap *heap, MemArena *arena, int capacity) {
+    heap->entries = ARENA_ALLOC_S(arena, MAX(capacity, 1), HeapEntry);
+    heap->pos = ARENA_ALLOC_S(arena, MAX(capacity, 1), int);
+    heap->count = 0;
+    if (!heap->entries || !heap->pos) return false;
+
+    for (int i = 0; i < capacity; i++) {
+        heap->pos[i] = HEAP_NONE;
+    }
+    return true;
+}
+
+static inline bool heap_empty(const IndexedHeap *heap) {
+    return heap->count == 0;
+}
+
+static inline bool heap_popped(const IndexedHeap *heap, int item) {
+    return heap->pos[item] == HEAP_POPPED;
+}
+
+static inline void heap_sift_up(IndexedHeap *heap, int i) {
+    HeapEntry entry = heap->entries[i];
+    while (i > 0) {
+        int parent = (i - 1) / HEAP_ARITY;
+        if (heap->entries[parent].key <= entry.key) break;
+
+        heap->entries[i] = heap->entries[parent];
+        heap->pos[heap->entries[i].item] = i;
+        i = parent;
+    }
+    heap->entries[i] = entry;
+    heap->pos[entry.item] = i;
+}
+
+static inline void heap_sift_down(IndexedHeap *heap, int i) {
+    HeapEntry entry = heap->entries[i];
+    while (true) {
+        int first = i * HEAP_ARITY + 1;
+        if (first >= heap->count) break;
+
+        int last = MIN(first + HEAP_ARITY, heap->count);
+        int best = first;
+        for (int c = first + 1; c < last; c++) {
+            if (heap->entries[c].key < heap->entries[best].key) {
+                best = c;
+            }
+        }
+        if (heap->entries[best].key >= entry.key) break;
+
+        heap->entries[i] = heap->entries[best];
+        heap->pos[heap->entries[i].item] = i;
+        i = best;
+    }
+    heap->entries[i] = entry;
+    heap->pos[entry.item] = i;
+}
+
+/* Insert item, or lower its key if it is queued with a larger one */
+static inline void heap_push_or_decrease(IndexedHeap *heap, int item, float key) {
+    int i = heap->pos[item];
+    if (i >= 0) {
+        if (key >= heap->entries[i].key) return;
+        heap->entries[i].key = key;
+    } else {
+        i = heap->count++;
+        heap->entries[i].key = key;
+        heap->entries[i].item = item;
+    }
+    heap_sift_up(heap, i);
+}
+
+/* Smallest key, FLT_MAX when empty */
+static inline float heap_min_key(const IndexedHeap *heap) {
+    return heap->count > 0 ? heap->entries[0].key : FLT_MAX;
+}
+
+/* Remove the item with the smallest key, the heap must not be empty */
+static inline int heap_pop(IndexedHeap *heap, float *key) {
+    HeapEntry top = heap->entries[0];
+    heap->pos[top.item] = HEAP_POPPED;
+    if (--heap->count > 0) {
+        heap->entries[0] = heap->entries[heap->count];
+        heap_sift_down(heap, 0);
+    }
+    if (key) *key = top.key;
+    return top.item;
+}
+
+#endif /* __HEAP_H__ */
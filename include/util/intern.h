@@ -0,0 +1,49 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file intern.h
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __INTERN_H__
+#define __INTERN_H__
+
+#include "util/memory.h"
+
+/* Handle of an interned string, equal handles mean equal strings */
+typedef uint32_t StrId;
+
+#define STR_ID_NONE 0           /* The empty string */
+
+#define STR_INTERN_PAGE_BITS 10
+#define STR_INTERN_MAX_PAGES 4096   /* Up to 4M distinct strings */
+
+/*
+ * Process-wide table. Interning takes a lock; str_get never does, and the
+ * returned pointer stays valid for the life of the process.
+ */
+StrId str_intern(const char *str);
+StrId str_intern_n(const char *str, size_t len);
+StrId str_find(const char *str);
+const char* str_get(StrId id);
+size_t str_len(StrId id);
+void str_intern_print_stats(void);
+
+#endif /* __INTERN_H__ */
@@ -25,22 +25,122 @@
 #ifndef __MEMORY_H__
 #define __MEMORY_H__
 
+#include "lanpulse_common.h"
+
 void* safe_malloc(const size_t size);
 
 void* safe_relloc(void *ptr, const size_t size);
 
 void* safe_calloc(const size_t count, const size_t size);
 
+void* safe_aligned_malloc(const size_t alignment, const size_t size);
+
 #define MALLOC_S(size) safe_malloc((size))
 
 #define RELLOC_S(ptr, size) safe_relloc((ptr), (size))
 
 #define CALLOC_S(count, size) safe_calloc((count), (size))
 
+#define MALLOC_ALIGNED_S(alignment, size) safe_aligned_malloc((alignment), (size))
+
 #define FREE_S(ptr) do{ \
     free((ptr)); \
     ptr = NULL; \
 }while(0)
 
+/* Slab pool */
+
+typedef struct MemPoolStats_ {
+    size_t slabs;       /* Slabs allocated */
+    size_t capacity;    /* Objects across all slabs */
+    size_t in_use;      /* Objects handed out */
+    size_t peak;        /* Highest in_use seen */
+    size_t allocs;
+    size_t frees;
+} MemPoolStats;
+
+/* Fixed-size objects carved from slabs, recycled through an intrusive free list */
+typedef struct MemPool_ {
+    const char *name;
+    size_t obj_size;
+    size_t align;
+    size_t objs_per_slab;
+    bool shared;        /* Guard with a spinlock when used from several threads */
+    char lock;
+    void *free_list;
+    void *slabs;
+    MemPoolStats stats;
+} MemPool;
+
+/* a must be a power of two */
+#define ALIGN_UP(x, a) (((x) + ((a) - 1)) & ~((a) - 1))
+
+/* Same stride mem_pool_init computes, so both initialisation paths agree */
+#define MEM_POOL_OBJ_ALIGN(type) MAX(_Alignof(type), _Alignof(void*))
+#define MEM_POOL_OBJ_SIZE(type)  ALIGN_UP(MAX(sizeof(type), sizeof(void*)), MEM_POOL_OBJ_ALIGN(type))
+
+#define MEM_POOL_INITIALIZER(name, type, per_slab, shared) \
+    { (name), MEM_POOL_OBJ_SIZE(type), MEM_POOL_OBJ_ALIGN(type), (per_slab), (shared), 0, NULL, NULL, {0} }
+
+void mem_pool_init(MemPool *pool, const char *name, size_t obj_size, size_t align,
+                   size_t objs_per_slab, bool shared);
+void mem_pool_destroy(MemPool *pool);
+void* mem_pool_alloc(MemPool *pool);
+void mem_pool_free(MemPool *pool, void *ptr);
+void mem_pool_print_stats(const MemPool *pool);
+
+#define MEM_POOL_INIT(pool, name, type, per_slab, shared) \
+    mem_pool_init((pool), (name), MEM_POOL_OBJ_SIZE(type), MEM_POOL_OBJ_ALIGN(type), (per_slab), (shared))
+
+#define POOL_ALLOC_S(pool, type) ((type*)mem_pool_alloc((pool)))
+
+#define POOL_FREE_S(pool, ptr) do{ \
+    mem_pool_free((pool), (ptr)); \
+    ptr = NULL; \
+}while(0)
+
+/* Bump-pointer arena */
+
+typedef struct MemArenaBlock_ {
+    struct MemArenaBlock_ *next;
+    size_t size;
+    size_t used;
+} MemArenaBlock;
+
+typedef struct MemArenaStats_ {
+    size_t blocks;
+    size_t reserved;    /* Bytes across all blocks */
+    size_t peak;        /* Highest bytes in use between resets */
+    size_t resets;
+} MemArenaStats;
+
+/* Blocks are kept across resets and reused in order */
+typedef struct MemArena_ {
+    MemArenaBlock *first;
+    MemArenaBlock *current;
+    size_t block_size;
+    size_t in_use;
+    MemArenaStats stats;
+} MemArena;
+
+typedef struct MemArenaMark_ {
+    MemArenaBlock *block;
+    size_t used;
+    size_t in_use;
+} MemArenaMark;
+
+void mem_arena_init(MemArena *arena, size_t block_size);
+void mem_arena_destroy(MemArena *arena);
+void* mem_arena_alloc(MemArena *arena, size_t size, size_t align);
+void mem_arena_reset(MemArena *arena);
+MemArenaMark mem_arena_mark(const MemArena *arena);
+void mem_arena_release(MemArena *arena, MemArenaMark mark);
+void mem_arena_print_stats(const MemArena *arena);
+
+MemArena* mem_thread_arena(void);
+void mem_thread_arena_destroy(void);
+
+#define ARENA_ALLOC_S(arena, count, type) \
+    ((type*)mem_arena_alloc((arena), (count) * sizeof(type), _Alignof(type)))
 
 #endif /* __MEMORY_H__ */
\ No newline at end of file
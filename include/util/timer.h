@@ -0,0 +1,78 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file timer.h
+ * @brief Hierarchical timing wheel.
+ *
+ * Timers are intrusive entries linked into one of TIMER_WHEEL_LEVELS rings of
+ * TIMER_WHEEL_SLOTS buckets, so arming and cancelling are O(1) and advancing
+ * only touches buckets that come due. A bucket of an upper level is spread
+ * over the level below when the lower ring wraps. The wheel is not locked,
+ * the owner serializes access.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __TIMER_H__
+#define __TIMER_H__
+
+#include "util/memory.h"
+
+#define TIMER_WHEEL_BITS   6
+#define TIMER_WHEEL_SLOTS  (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK   (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS 5    /* 2^30 ticks, longer timeouts are clamped */
+
+struct TimerEntry_;
+typedef void (*TimerCallback)(struct TimerEntry_ *timer, void *arg);
+
+/* Embed in the owning object */
+typedef struct TimerEntry_ {
+    struct TimerEntry_ *next;
+    struct TimerEntry_ **pprev;   /* NULL while not armed */
+    uint64_t expires;             /* Tick */
+    TimerCallback callback;
+} TimerEntry;
+
+typedef struct TimerWheel_ {
+    TimerEntry *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    uint64_t tick;                /* Next tick to run */
+    unsigned int tick_ms;
+    int count;                    /* Armed timers */
+} TimerWheel;
+
+#define TIMER_ENTRY_INITIALIZER(cb) { NULL, NULL, 0, (cb) }
+
+/* Function */
+
+uint64_t timer_monotonic_ms(void);
+
+void timer_wheel_init(TimerWheel *wheel, unsigned int tick_ms, uint64_t now_ms);
+void timer_entry_init(TimerEntry *timer, TimerCallback callback);
+
+void timer_wheel_arm(TimerWheel *wheel, TimerEntry *timer, uint64_t expires_ms);
+void timer_wheel_cancel(TimerWheel *wheel, TimerEntry *timer);
+int timer_wheel_advance(TimerWheel *wheel, uint64_t now_ms, void *arg);
+
+static inline bool timer_pending(const TimerEntry *timer) {
+    return timer->pprev != NULL;
+}
+
+#endif /* __TIMER_H__ */
@@ -0,0 +1,277 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file batch.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/batch.h"
+
+/* Sort key, one per queued operation */
+typedef struct BatchKey_ {
+    int target;     /* 0 for node operations, 1 for edge operations */
+    int phase;      /* GraphOpType */
+    int a;
+    int b;
+    int seq;        /* Position in the batch */
+} BatchKey;
+
+void GraphBatchInit(GraphBatch *batch) {
+    batch->ops = NULL;
+    batch->count = 0;
+    batch->capacity = 0;
+}
+
+void GraphBatchClear(GraphBatch *batch) {
+    for (int i = 0; i < batch->count; i++) {
+        if (batch->ops[i].type == GRAPH_OP_UPSERT_NODE) {
+            NodeRelease(&batch->ops[i].data.device);
+        }
+    }
+    batch->count = 0;
+}
+
+void GraphBatchFree(GraphBatch *batch) {
+    GraphBatchClear(batch);
+    if (batch->ops) FREE_S(batch->ops);
+    batch->capacity = 0;
+}
+
+static GraphOp* GraphBatchPush(GraphBatch *batch, GraphOpType type, int from_id, int to_id) {
+    if (batch->count >= batch->capacity) {
+        int new_capacity = batch->capacity ? batch->capacity * 2 : 64;
+        GraphOp *new_ops = (GraphOp*)RELLOC_S(batch->ops, new_capacity * sizeof(GraphOp));
+        if (!new_ops) return NULL;
+
+        batch->ops = new_ops;
+        batch->capacity = new_capacity;
+    }
+
+    GraphOp *op = &batch->ops[batch->count++];
+    op->type = type;
+    op->from_id = from_id;
+    op->to_id = to_id;
+    return op;
+}
+
+bool GraphBatchUpsertNode(GraphBatch *batch, int node_id, Device data) {
+    GraphOp *op = GraphBatchPush(batch, GRAPH_OP_UPSERT_NODE, node_id, GRAPH_INVALID_ID);
+    if (!op) return false;
+
+    op->data.device = data;
+    return true;
+}
+
+bool GraphBatchRemoveNode(GraphBatch *batch, int node_id) {
+    return GraphBatchPush(batch, GRAPH_OP_REMOVE_NODE, node_id, GRAPH_INVALID_ID) != NULL;
+}
+
+bool GraphBatchUpsertEdge(GraphBatch *batch, int from_id, int to_id, EdgeData data) {
+    GraphOp *op = GraphBatchPush(batch, GRAPH_OP_UPSERT_EDGE, from_id, to_id);
+    if (!op) return false;
+
+    op->data.edge = data;
+    return true;
+}
+
+bool GraphBatchRemoveEdge(GraphBatch *batch, int from_id, int to_id) {
+    return GraphBatchPush(batch, GRAPH_OP_REMOVE_EDGE, from_id, to_id) != NULL;
+}
+
+// 排序
+static int BatchKeyCompareTarget(const void *lhs, const void *rhs) {
+    const BatchKey *x = (const BatchKey*)lhs;
+    const BatchKey *y = (const BatchKey*)rhs;
+
+    if (x->target != y->target) return x->target - y->target;
+    if (x->a != y->a) return x->a < y->a ? -1 : 1;
+    if (x->b != y->b) return x->b < y->b ? -1 : 1;
+    return x->seq - y->seq;
+}
+
+static int BatchKeyComparePhase(const void *lhs, const void *rhs) {
+    const BatchKey *x = (const BatchKey*)lhs;
+    const BatchKey *y = (const BatchKey*)rhs;
+
+    if (x->phase != y->phase) return x->phase - y->phase;
+    if (x->a != y->a) return x->a < y->a ? -1 : 1;
+    if (x->b != y->b) return x->b < y->b ? -1 : 1;
+    return x->seq - y->seq;
+}
+
+static bool BatchSameTarget(const BatchKey *x, const BatchKey *y) {
+    return x->target == y->target && x->a == y->a && x->b == y->b;
+}
+
+// 节点最后一次删除在批次中的位置，没有删除时为 -1；removals 按 a 有序
+static int BatchRemovalSeq(const BatchKey *removals, int count, int node_id) {
+    int lo = 0, hi = count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (removals[mid].a == node_id) return removals[mid].seq;
+        if (removals[mid].a < node_id) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+/*
+ * 同一目标的多次操作只保留最后一次，返回保留数量。节点先删除后写入时
+ * 同时保留删除，按阶段顺序先删除再重新添加，旧的边不会残留；早于端点
+ * 删除的边操作已被删除抹掉，直接丢弃
+ */
+static int BatchDedupe(GraphBatch *batch, BatchKey *keys, int count) {
+    qsort(keys, count, sizeof(BatchKey), BatchKeyCompareTarget);
+
+    BatchKey *removals = (BatchKey*)MALLOC_S(MAX(count, 1) * sizeof(BatchKey));
+    int removal_count = 0;
+    int kept = 0;
+    int start = 0;
+    while (start < count) {
+        int end = start + 1;
+        while (end < count && BatchSameTarget(&keys[end], &keys[start])) {
+            end++;
+        }
+
+        // 组内按 seq 升序，最后一个即最终操作
+        BatchKey last = keys[end - 1];
+        int removal = -1;
+        for (int i = start; i < end - 1; i++) {
+            if (keys[i].phase == GRAPH_OP_REMOVE_NODE) {
+                removal = i;
+            } else if (keys[i].phase == GRAPH_OP_UPSERT_NODE) {
+                NodeRelease(&batch->ops[keys[i].seq].data.device);
+            }
+        }
+
+        bool dropped = false;
+        if (last.target == 0) {
+            if (last.phase == GRAPH_OP_REMOVE_NODE) removal = end - 1;
+            if (removal >= 0 && removals) {
+                removals[removal_count++] = keys[removal];
+            }
+            if (removal >= 0 && removal != end - 1) {
+                keys[kept++] = keys[removal];
+            }
+        } else if (removals) {
+            dropped = last.seq < BatchRemovalSeq(removals, removal_count, last.a) ||
+                      last.seq < BatchRemovalSeq(removals, removal_count, last.b);
+        }
+        if (!dropped) {
+            keys[kept++] = last;
+        }
+        start = end;
+    }
+
+    if (removals) FREE_S(removals);
+    return kept;
+}
+
+static bool BatchApplyOp(Graph *graph, GraphOp *op) {
+    switch (op->type) {
+        case GRAPH_OP_REMOVE_EDGE:
+            return GraphRemoveEdge(graph, op->from_id, op->to_id);
+        case GRAPH_OP_REMOVE_NODE:
+            return GraphRemoveNode(graph, op->from_id);
+        case GRAPH_OP_UPSERT_NODE: {
+            bool ok = GraphGetNode(graph, op->from_id)
+                      ? GraphUpdateNode(graph, op->from_id, op->data.device)
+                      : GraphAddNodeWithId(graph, op->from_id, op->data.device) != NULL;
+            if (!ok) {
+                NodeRelease(&op->data.device);
+            }
+            return ok;
+        }
+        case GRAPH_OP_UPSERT_EDGE:
+            return GraphAddEdge(graph, op->from_id, op->to_id, op->data.edge);
+        default:
+            return false;
+    }
+}
+
+/*
+ * Apply every queued operation: removals first, then node upserts, then
+ * edge upserts. Later operations on the same node or edge replace earlier
+ * ones; a node removed and then upserted comes back without its old edges.
+ * The graph version moves by exactly one when anything changed. The batch
+ * is consumed and left empty.
+ */
+int GraphApplyBatch(Graph *graph, GraphBatch *batch) {
+    if (!graph || !batch) return -1;
+    if (batch->count == 0) return 0;
+
+    BatchKey *keys = (BatchKey*)MALLOC_S(batch->count * sizeof(BatchKey));
+    if (!keys) return -1;
+
+    for (int i = 0; i < batch->count; i++) {
+        const GraphOp *op = &batch->ops[i];
+        bool edge = (op->type == GRAPH_OP_REMOVE_EDGE || op->type == GRAPH_OP_UPSERT_EDGE);
+
+        keys[i].target = edge ? 1 : 0;
+        keys[i].phase = op->type;
+        keys[i].a = op->from_id;
+        keys[i].b = op->to_id;
+        keys[i].seq = i;
+        // 无向图中 (a, b) 与 (b, a) 是同一条边
+        if (edge && !graph->directed && keys[i].a > keys[i].b) {
+            SWAP_VAR(int, keys[i].a, keys[i].b);
+        }
+    }
+
+    int count = BatchDedupe(batch, keys, batch->count);
+    qsort(keys, count, sizeof(BatchKey), BatchKeyComparePhase);
+
+    // 预先分配新节点所需容量
+    int new_nodes = 0;
+    for (int i = 0; i < count; i++) {
+        const GraphOp *op = &batch->ops[keys[i].seq];
+        if (op->type == GRAPH_OP_UPSERT_NODE && !GraphGetNode(graph, op->from_id)) {
+            new_nodes++;
+        }
+    }
+    GraphReserve(graph, new_nodes);
+
+    GraphBeginUpdate(graph);
+    int applied = 0;
+    for (int i = 0; i < count; i++) {
+        GraphOp *op = &batch->ops[keys[i].seq];
+
+        // 同一起点的边连续排列，按段一次性扩容邻接数组
+        if (op->type == GRAPH_OP_UPSERT_EDGE && (i == 0 || keys[i - 1].phase != GRAPH_OP_UPSERT_EDGE ||
+                                                 keys[i - 1].a != keys[i].a)) {
+            int run = 1;
+            while (i + run < count && keys[i + run].a == keys[i].a) {
+                run++;
+            }
+            GraphReserveEdges(graph, keys[i].a, run);
+        }
+
+        if (BatchApplyOp(graph, op)) {
+            applied++;
+        }
+    }
+
+    GraphEndUpdate(graph);
+
+    // 节点数据已交给图或已释放
+    FREE_S(keys);
+    batch->count = 0;
+    return applied;
+}
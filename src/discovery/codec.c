@@ -0,0 +1,578 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file codec.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/codec.h"
+
+#define CODEC_IP_NONE 0
+#define CODEC_IP_V4   4
+#define CODEC_IP_V6   6
+
+/* Growable output buffer, failed sticks once an allocation fails */
+typedef struct CodecWriter_ {
+    uint8_t *data;
+    size_t len;
+    size_t cap;
+    bool failed;
+} CodecWriter;
+
+/* Bounds-checked input cursor, failed sticks once input runs out or is invalid */
+typedef struct CodecReader_ {
+    const uint8_t *p;
+    const uint8_t *end;
+    bool failed;
+} CodecReader;
+
+/* Encoder string table, interned handle -> wire index, open addressing */
+typedef struct CodecString_ {
+    uint32_t key;               /* StrId + 1, 0 when empty */
+    uint32_t index;
+} CodecString;
+
+typedef struct CodecStrings_ {
+    CodecString *entries;
+    uint32_t mask;
+    uint32_t count;
+} CodecStrings;
+
+/* Decoder string table, wire index -> interned handle */
+typedef struct CodecIds_ {
+    StrId *items;
+    uint32_t count;
+    uint32_t capacity;
+} CodecIds;
+
+/* Previous edge, metrics are encoded against it */
+typedef struct CodecMetrics_ {
+    uint32_t bandwidth;
+    uint32_t latency;           /* Float bits */
+    uint32_t packet_loss;       /* Float bits */
+    uint16_t port;
+    uint64_t traffic;
+    int64_t last_communication;
+} CodecMetrics;
+
+static inline uint64_t CodecZigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t CodecUnzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+// 浮点按位异或前一个值，再翻转字节序，使相同或整齐的数值编码更短
+static inline uint32_t CodecFloatDelta(float value, uint32_t prev) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return __builtin_bswap32(bits ^ prev);
+}
+
+static inline float CodecFloatApply(uint32_t delta, uint32_t *prev) {
+    float value;
+    *prev ^= __builtin_bswap32(delta);
+    memcpy(&value, prev, sizeof(value));
+    return value;
+}
+
+// 写入
+static bool CodecReserve(CodecWriter *w, size_t n) {
+    if (w->failed) return false;
+    if (w->len + n <= w->cap) return true;
+
+    size_t cap = w->cap ? w->cap : 256;
+    while (cap < w->len + n) {
+        cap *= 2;
+    }
+    uint8_t *data = (uint8_t*)RELLOC_S(w->data, cap);
+    if (!data) {
+        w->failed = true;
+        return false;
+    }
+    w->data = data;
+    w->cap = cap;
+    return true;
+}
+
+static void CodecPutBytes(CodecWriter *w, const void *src, size_t n) {
+    if (n == 0 || !CodecReserve(w, n)) return;
+
+    memcpy(w->data + w->len, src, n);
+    w->len += n;
+}
+
+static void CodecPutByte(CodecWriter *w, uint8_t v) {
+    CodecPutBytes(w, &v, 1);
+}
+
+static void CodecPutVarint(CodecWriter *w, uint64_t v) {
+    uint8_t buf[10];
+    int n = 0;
+    while (v >= 0x80) {
+        buf[n++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    buf[n++] = (uint8_t)v;
+    CodecPutBytes(w, buf, n);
+}
+
+static void CodecPutZigzag(CodecWriter *w, int64_t v) {
+    CodecPutVarint(w, CodecZigzag(v));
+}
+
+static void CodecPutIp(CodecWriter *w, const IPAddress *ip) {
+    if (ip->family == AF_INET) {
+        CodecPutByte(w, CODEC_IP_V4);
+        CodecPutBytes(w, &ip->address, 4);
+    } else if (ip->family == AF_INET6) {
+        CodecPutByte(w, CODEC_IP_V6);
+        CodecPutBytes(w, &ip->address, 16);
+    } else {
+        CodecPutByte(w, CODEC_IP_NONE);
+    }
+}
+
+// 字符串首次出现时写入内容，之后只写编号：0 表示新字符串，k 表示第 k-1 个
+// 驻留句柄相等即字符串相等，查表无需比较内容
+static void CodecPutString(CodecWriter *w, CodecStrings *strings, StrId id) {
+    uint32_t key = id + 1;
+    uint32_t h = (key * 2654435761U) & strings->mask;
+
+    while (strings->entries[h].key) {
+        if (strings->entries[h].key == key) {
+            CodecPutVarint(w, (uint64_t)strings->entries[h].index + 1);
+            return;
+        }
+        h = (h + 1) & strings->mask;
+    }
+
+    strings->entries[h].key = key;
+    strings->entries[h].index = strings->count++;
+    CodecPutVarint(w, 0);
+    CodecPutVarint(w, str_len(id));
+    CodecPutBytes(w, str_get(id), str_len(id));
+}
+
+// 不驻留的定长字段（MAC）直接写入长度和内容
+static void CodecPutText(CodecWriter *w, const char *text, size_t size) {
+    size_t len = strnlen(text, size);
+    CodecPutVarint(w, len);
+    CodecPutBytes(w, text, len);
+}
+
+static void CodecPutNode(CodecWriter *w, CodecStrings *strings, const GraphNode *node, const Device *device) {
+    CodecPutVarint(w, node->flags);
+    CodecPutVarint(w, device->platform);
+    CodecPutVarint(w, device->subplatform);
+    CodecPutString(w, strings, device->hostname);
+    CodecPutString(w, strings, device->os_version);
+    CodecPutString(w, strings, device->architecture);
+    CodecPutVarint(w, device->memory);
+    CodecPutVarint(w, device->storage);
+    CodecPutIp(w, &device->public_ip);
+    CodecPutIp(w, &device->private_ip);
+
+    CodecPutVarint(w, device->iface_count);
+    CodecPutVarint(w, device->iface ? (uint64_t)(device->iface - device->ifaces) + 1 : 0);
+    for (int k = 0; k < device->iface_count; k++) {
+        const NetworkInterface *iface = &device->ifaces[k];
+        CodecPutString(w, strings, iface->name);
+        CodecPutIp(w, &iface->ip);
+        CodecPutText(w, iface->mac, sizeof(iface->mac));
+        CodecPutVarint(w, iface->mtu);
+    }
+}
+
+static void CodecPutEdge(CodecWriter *w, CodecMetrics *prev, const EdgeData *data) {
+    CodecPutByte(w, (uint8_t)data->utilize);
+    CodecPutZigzag(w, (int64_t)data->bandwidth - prev->bandwidth);
+    CodecPutVarint(w, CodecFloatDelta(data->latency, prev->latency));
+    CodecPutVarint(w, CodecFloatDelta(data->packet_loss, prev->packet_loss));
+    CodecPutZigzag(w, (int64_t)data->port - prev->port);
+    CodecPutZigzag(w, (int64_t)(uint64_t)(data->traffic - prev->traffic));
+    CodecPutZigzag(w, (int64_t)((uint64_t)data->last_communication - (uint64_t)prev->last_communication));
+
+    prev->bandwidth = data->bandwidth;
+    memcpy(&prev->latency, &data->latency, sizeof(prev->latency));
+    memcpy(&prev->packet_loss, &data->packet_loss, sizeof(prev->packet_loss));
+    prev->port = data->port;
+    prev->traffic = data->traffic;
+    prev->last_communication = data->last_communication;
+}
+
+// 无向图的边只写一次，由 (较小槽位, 较大槽位) 一侧写出
+static inline bool CodecEdgeOwned(const Graph *graph, const GraphNode *node, const GraphEdge *edge) {
+    return graph->directed || edge->slot >= node->slot;
+}
+
+/* Encode the whole graph into one malloc'ed buffer, the caller frees it */
+void* GraphEncode(Graph *graph, size_t *size) {
+    if (!graph || !size) return NULL;
+
+    uint32_t string_slots = 0, edge_count = 0;
+    for (int i = 0; i < graph->slot_count; i++) {
+        const GraphNode *node = graph->nodes[i];
+        if (!node) continue;
+
+        string_slots += 3 + 2 * graph->devices[i].iface_count;
+        for (int k = 0; k < node->neighbor_count; k++) {
+            edge_count += CodecEdgeOwned(graph, node, &node->edges[k]);
+        }
+    }
+
+    MemArena *scratch = mem_thread_arena();
+    MemArenaMark mark = mem_arena_mark(scratch);
+
+    // 字符串表负载因子不超过 1/2
+    CodecStrings strings = { NULL, 1, 0 };
+    while (strings.mask + 1 < string_slots * 2) {
+        strings.mask = (strings.mask << 1) | 1;
+    }
+    strings.entries = ARENA_ALLOC_S(scratch, strings.mask + 1, CodecString);
+    int *index = ARENA_ALLOC_S(scratch, MAX(graph->slot_count, 1), int);
+    if (!strings.entries || !index) {
+        mem_arena_release(scratch, mark);
+        return NULL;
+    }
+    memset(strings.entries, 0, (strings.mask + 1) * sizeof(CodecString));
+
+    CodecWriter w = { NULL, 0, 0, false };
+    CodecPutBytes(&w, GRAPH_CODEC_MAGIC, 3);
+    CodecPutByte(&w, GRAPH_CODEC_FORMAT);
+    CodecPutByte(&w, graph->directed ? GRAPH_CODEC_DIRECTED : 0);
+    CodecPutVarint(&w, graph->version);
+    CodecPutVarint(&w, graph->node_count);
+    CodecPutVarint(&w, edge_count);
+
+    int prev_id = 0;
+    for (int i = 0, n = 0; i < graph->slot_count; i++) {
+        const GraphNode *node = graph->nodes[i];
+        index[i] = node ? n++ : -1;
+        if (!node) continue;
+
+        CodecPutZigzag(&w, (int64_t)node->id - prev_id);
+        prev_id = node->id;
+        CodecPutNode(&w, &strings, node, &graph->devices[i]);
+    }
+
+    // 边目标按节点序号差值编码，相邻节点的序号通常接近
+    CodecMetrics prev;
+    memset(&prev, 0, sizeof(prev));
+    for (int i = 0; i < graph->slot_count; i++) {
+        const GraphNode *node = graph->nodes[i];
+        if (!node) continue;
+
+        uint32_t count = 0;
+        for (int k = 0; k < node->neighbor_count; k++) {
+            count += CodecEdgeOwned(graph, node, &node->edges[k]);
+        }
+        CodecPutVarint(&w, count);
+
+        for (int k = 0; k < node->neighbor_count; k++) {
+            const GraphEdge *edge = &node->edges[k];
+            if (!CodecEdgeOwned(graph, node, edge)) continue;
+
+            CodecPutZigzag(&w, (int64_t)index[edge->slot] - index[i]);
+            CodecPutEdge(&w, &prev, &edge->data);
+        }
+    }
+    mem_arena_release(scratch, mark);
+
+    if (w.failed) {
+        FREE_S(w.data);
+        return NULL;
+    }
+    *size = w.len;
+    return w.data;
+}
+
+// 读取
+static const uint8_t* CodecGetBytes(CodecReader *r, uint64_t n) {
+    if (r->failed || n > (uint64_t)(r->end - r->p)) {
+        r->failed = true;
+        return NULL;
+    }
+    const uint8_t *p = r->p;
+    r->p += n;
+    return p;
+}
+
+static uint8_t CodecGetByte(CodecReader *r) {
+    const uint8_t *p = CodecGetBytes(r, 1);
+    return p ? *p : 0;
+}
+
+static uint64_t CodecGetVarint(CodecReader *r) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t b = CodecGetByte(r);
+        if (r->failed) return 0;
+
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    r->failed = true;
+    return 0;
+}
+
+static int64_t CodecGetZigzag(CodecReader *r) {
+    return CodecUnzigzag(CodecGetVarint(r));
+}
+
+/* Read a count that needs at least min_bytes of input per element */
+static uint32_t CodecGetCount(CodecReader *r, uint32_t min_bytes) {
+    uint64_t count = CodecGetVarint(r);
+    if (count > INT_MAX || count * min_bytes > (uint64_t)(r->end - r->p)) {
+        r->failed = true;
+        return 0;
+    }
+    return (uint32_t)count;
+}
+
+static void CodecGetIp(CodecReader *r, IPAddress *ip) {
+    const uint8_t *p;
+    memset(ip, 0, sizeof(IPAddress));
+    switch (CodecGetByte(r)) {
+        case CODEC_IP_NONE:
+            break;
+        case CODEC_IP_V4:
+            if ((p = CodecGetBytes(r, 4))) {
+                ip->family = AF_INET;
+                memcpy(&ip->address, p, 4);
+            }
+            break;
+        case CODEC_IP_V6:
+            if ((p = CodecGetBytes(r, 16))) {
+                ip->family = AF_INET6;
+                memcpy(&ip->address, p, 16);
+            }
+            break;
+        default:
+            r->failed = true;
+            break;
+    }
+}
+
+// 新字符串直接从输入缓冲区驻留，不经中间副本
+static StrId CodecGetString(CodecReader *r, CodecIds *strings) {
+    uint64_t ref = CodecGetVarint(r);
+    if (r->failed) return STR_ID_NONE;
+
+    if (ref > 0) {
+        if (ref <= strings->count) return strings->items[ref - 1];
+        r->failed = true;
+        return STR_ID_NONE;
+    }
+
+    uint64_t len = CodecGetVarint(r);
+    const uint8_t *ptr = CodecGetBytes(r, len);
+    if (!ptr) return STR_ID_NONE;
+
+    if (strings->count >= strings->capacity) {
+        uint32_t capacity = strings->capacity ? strings->capacity * 2 : 64;
+        StrId *items = (StrId*)RELLOC_S(strings->items, capacity * sizeof(StrId));
+        if (!items) {
+            r->failed = true;
+            return STR_ID_NONE;
+        }
+        strings->items = items;
+        strings->capacity = capacity;
+    }
+    StrId id = str_intern_n((const char*)ptr, len);
+    strings->items[strings->count++] = id;
+    return id;
+}
+
+static void CodecGetText(CodecReader *r, char *out, size_t size) {
+    uint64_t len = CodecGetVarint(r);
+    const uint8_t *ptr = CodecGetBytes(r, len);
+    size_t n = ptr ? MIN((size_t)len, size - 1) : 0;
+    if (n > 0) {
+        memcpy(out, ptr, n);
+    }
+    out[n] = '\0';
+}
+
+static bool CodecGetNode(CodecReader *r, CodecIds *strings, unsigned int *flags, Device *device) {
+    memset(device, 0, sizeof(Device));
+    *flags = (unsigned int)CodecGetVarint(r);
+    device->platform = (Platform)CodecGetVarint(r);
+    device->subplatform = (SubPlatType)CodecGetVarint(r);
+    device->hostname = CodecGetString(r, strings);
+    device->os_version = CodecGetString(r, strings);
+    device->architecture = CodecGetString(r, strings);
+    device->memory = CodecGetVarint(r);
+    device->storage = CodecGetVarint(r);
+    CodecGetIp(r, &device->public_ip);
+    CodecGetIp(r, &device->private_ip);
+
+    // 每个接口至少占 4 字节，数量先按剩余输入校验再分配
+    uint32_t iface_count = CodecGetCount(r, 4);
+    uint64_t iface_used = CodecGetVarint(r);
+    if (r->failed || iface_used > iface_count) {
+        r->failed = true;
+        return false;
+    }
+    if (iface_count == 0) return true;
+
+    device->ifaces = (NetworkInterface*)CALLOC_S(iface_count, sizeof(NetworkInterface));
+    if (!device->ifaces) {
+        r->failed = true;
+        return false;
+    }
+    device->iface_count = (int)iface_count;
+    for (uint32_t k = 0; k < iface_count; k++) {
+        NetworkInterface *iface = &device->ifaces[k];
+        iface->name = CodecGetString(r, strings);
+        CodecGetIp(r, &iface->ip);
+        CodecGetText(r, iface->mac, sizeof(iface->mac));
+        iface->mtu = (unsigned int)CodecGetVarint(r);
+    }
+    if (iface_used > 0) {
+        device->iface = &device->ifaces[iface_used - 1];
+    }
+    return !r->failed;
+}
+
+static void CodecGetEdge(CodecReader *r, CodecMetrics *prev, EdgeData *data) {
+    memset(data, 0, sizeof(EdgeData));
+    data->utilize = (char)CodecGetByte(r);
+    prev->bandwidth += (uint32_t)CodecGetZigzag(r);
+    data->bandwidth = prev->bandwidth;
+    data->latency = CodecFloatApply((uint32_t)CodecGetVarint(r), &prev->latency);
+    data->packet_loss = CodecFloatApply((uint32_t)CodecGetVarint(r), &prev->packet_loss);
+    prev->port += (uint16_t)CodecGetZigzag(r);
+    data->port = prev->port;
+    prev->traffic += (uint64_t)CodecGetZigzag(r);
+    data->traffic = prev->traffic;
+    prev->last_communication = (int64_t)((uint64_t)prev->last_communication + (uint64_t)CodecGetZigzag(r));
+    data->last_communication = (time_t)prev->last_communication;
+}
+
+static bool CodecGetHeader(CodecReader *r, bool *directed) {
+    const uint8_t *magic = CodecGetBytes(r, 3);
+    if (!magic || memcmp(magic, GRAPH_CODEC_MAGIC, 3) != 0 || CodecGetByte(r) != GRAPH_CODEC_FORMAT) {
+        return false;
+    }
+    *directed = (CodecGetByte(r) & GRAPH_CODEC_DIRECTED) != 0;
+    CodecGetVarint(r);      // 对端版本号，仅供参考
+    return !r->failed;
+}
+
+/*
+ * Upsert every node and edge of an encoded graph, under one version bump.
+ * Returns the number of nodes and edges applied, or -1 on malformed input
+ * or a directedness mismatch. Changes decoded before an error are kept.
+ */
+int GraphDecodeInto(Graph *graph, const void *buf, size_t size) {
+    if (!graph || !buf) return -1;
+
+    CodecReader r = { (const uint8_t*)buf, (const uint8_t*)buf + size, false };
+    bool directed;
+    if (!CodecGetHeader(&r, &directed) || directed != graph->directed) return -1;
+
+    uint32_t node_count = CodecGetCount(&r, 1);
+    uint32_t edge_count = CodecGetCount(&r, 1);
+    if (r.failed) return -1;
+
+    MemArena *scratch = mem_thread_arena();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    int *ids = ARENA_ALLOC_S(scratch, MAX(node_count, 1), int);
+    if (!ids) {
+        mem_arena_release(scratch, mark);
+        return -1;
+    }
+
+    CodecIds strings = { NULL, 0, 0 };
+    int applied = 0;
+    int64_t id = 0;
+
+    GraphBeginUpdate(graph);
+    GraphReserve(graph, (int)node_count);
+
+    for (uint32_t i = 0; i < node_count && !r.failed; i++) {
+        id = (int64_t)((uint64_t)id + (uint64_t)CodecGetZigzag(&r));
+        unsigned int flags;
+        Device device;
+        bool ok = CodecGetNode(&r, &strings, &flags, &device) && id > GRAPH_INVALID_ID && id <= INT_MAX;
+        if (ok) {
+            GraphNode *node = GraphGetNode(graph, (int)id);
+            if (node) {
+                ok = GraphUpdateNode(graph, (int)id, device);
+            } else if ((node = GraphAddNodeWithId(graph, (int)id, device))) {
+                // 对端的本机标记对本地无意义
+                node->flags = flags & ~NODE_FLAG_LOCAL;
+            } else {
+                ok = false;
+            }
+        }
+        if (!ok) {
+            NodeRelease(&device);
+            r.failed = true;
+            break;
+        }
+        ids[i] = (int)id;
+        applied++;
+    }
+
+    CodecMetrics prev;
+    memset(&prev, 0, sizeof(prev));
+    uint32_t edges_seen = 0;
+    for (uint32_t i = 0; i < node_count && !r.failed; i++) {
+        uint32_t count = CodecGetCount(&r, 1);
+        GraphReserveEdges(graph, ids[i], (int)count);
+
+        for (uint32_t k = 0; k < count && !r.failed; k++) {
+            int64_t target = (int64_t)((uint64_t)i + (uint64_t)CodecGetZigzag(&r));
+            EdgeData data;
+            CodecGetEdge(&r, &prev, &data);
+            if (r.failed || target < 0 || target >= node_count ||
+                !GraphAddEdge(graph, ids[i], ids[target], data)) {
+                r.failed = true;
+                break;
+            }
+            edges_seen++;
+            applied++;
+        }
+    }
+
+    GraphEndUpdate(graph);
+    FREE_S(strings.items);
+    mem_arena_release(scratch, mark);
+
+    if (r.failed || edges_seen != edge_count || r.p != r.end) return -1;
+    return applied;
+}
+
+/* Decode into a new graph, NULL on malformed input */
+Graph* GraphDecode(const void *buf, size_t size) {
+    CodecReader r = { (const uint8_t*)buf, (const uint8_t*)buf + size, false };
+    bool directed;
+    if (!buf || !CodecGetHeader(&r, &directed)) return NULL;
+
+    Graph *graph = GraphCreate(directed);
+    if (graph && GraphDecodeInto(graph, buf, size) < 0) {
+        GraphDestroy(graph);
+        return NULL;
+    }
+    return graph;
+}
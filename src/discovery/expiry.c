@@ -0,0 +1,249 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file expiry.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/expiry.h"
+
+#define EXPIRY_TABLE_INIT_CAPACITY 64
+
+// 记录索引，键为 (from_id, to_id)
+static inline unsigned int ExpiryHash(int from_id, int to_id) {
+    uint32_t h = (uint32_t)from_id * 0x9e3779b1U ^ (uint32_t)to_id;
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+static int ExpiryFindIndex(const GraphExpiry *expiry, int from_id, int to_id) {
+    unsigned int i = ExpiryHash(from_id, to_id) & expiry->mask;
+    while (expiry->table[i]) {
+        if (expiry->table[i]->from_id == from_id && expiry->table[i]->to_id == to_id) {
+            return i;
+        }
+        i = (i + 1) & expiry->mask;
+    }
+    return -1;
+}
+
+static void ExpiryPut(ExpiryRecord **table, unsigned int mask, ExpiryRecord *record) {
+    unsigned int i = ExpiryHash(record->from_id, record->to_id) & mask;
+    while (table[i]) {
+        i = (i + 1) & mask;
+    }
+    table[i] = record;
+}
+
+static bool ExpiryGrow(GraphExpiry *expiry) {
+    unsigned int capacity = (expiry->mask + 1) * 2;
+    ExpiryRecord **table = (ExpiryRecord**)CALLOC_S(capacity, sizeof(ExpiryRecord*));
+    if (!table) return false;
+
+    for (unsigned int i = 0; i <= expiry->mask; i++) {
+        if (expiry->table[i]) {
+            ExpiryPut(table, capacity - 1, expiry->table[i]);
+        }
+    }
+    FREE_S(expiry->table);
+    expiry->table = table;
+    expiry->mask = capacity - 1;
+    return true;
+}
+
+// 删除后回移探测链，与图的 Id 索引相同
+static void ExpiryErase(GraphExpiry *expiry, unsigned int i) {
+    unsigned int j = i;
+    expiry->table[i] = NULL;
+    while (true) {
+        j = (j + 1) & expiry->mask;
+        ExpiryRecord *record = expiry->table[j];
+        if (!record) break;
+
+        unsigned int k = ExpiryHash(record->from_id, record->to_id) & expiry->mask;
+        if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) continue;
+
+        expiry->table[i] = record;
+        expiry->table[j] = NULL;
+        i = j;
+    }
+    expiry->count--;
+}
+
+static void ExpiryRecordFree(GraphExpiry *expiry, int index) {
+    ExpiryRecord *record = expiry->table[index];
+    timer_wheel_cancel(&expiry->wheel, &record->timer);
+    ExpiryErase(expiry, index);
+    mem_pool_free(&expiry->pool, record);
+}
+
+// 到期：登记删除，由 GraphExpiryAdvance 统一应用
+static void ExpiryFire(TimerEntry *timer, void *arg) {
+    GraphExpiry *expiry = (GraphExpiry*)arg;
+    ExpiryRecord *record = (ExpiryRecord*)timer;
+
+    bool queued = true;
+    if (record->to_id == GRAPH_INVALID_ID) {
+        // 本机节点不会过期
+        GraphNode *node = GraphGetNode(expiry->graph, record->from_id);
+        if (!node || !(node->flags & NODE_FLAG_LOCAL)) {
+            queued = GraphBatchRemoveNode(&expiry->departed, record->from_id);
+        }
+    } else {
+        queued = GraphBatchRemoveEdge(&expiry->departed, record->from_id, record->to_id);
+    }
+
+    // 无法登记时下一个 tick 重试
+    if (!queued) {
+        timer_wheel_arm(&expiry->wheel, timer, 0);
+        return;
+    }
+    ExpiryRecordFree(expiry, ExpiryFindIndex(expiry, record->from_id, record->to_id));
+}
+
+static bool ExpiryArm(GraphExpiry *expiry, int from_id, int to_id, uint64_t expires_ms) {
+    int index = ExpiryFindIndex(expiry, from_id, to_id);
+    if (index >= 0) {
+        timer_wheel_arm(&expiry->wheel, &expiry->table[index]->timer, expires_ms);
+        return true;
+    }
+
+    if ((expiry->count + 1) * 2 > (int)(expiry->mask + 1) && !ExpiryGrow(expiry)) return false;
+
+    ExpiryRecord *record = POOL_ALLOC_S(&expiry->pool, ExpiryRecord);
+    if (!record) return false;
+
+    timer_entry_init(&record->timer, ExpiryFire);
+    record->from_id = from_id;
+    record->to_id = to_id;
+    ExpiryPut(expiry->table, expiry->mask, record);
+    expiry->count++;
+    timer_wheel_arm(&expiry->wheel, &record->timer, expires_ms);
+    return true;
+}
+
+/*
+ * Track expiry for graph. Nodes and edges already in the graph start with a
+ * full timeout, so peers restored from an image leave unless they are heard from.
+ */
+GraphExpiry* GraphExpiryCreate(Graph *graph, unsigned int node_timeout_ms, unsigned int edge_timeout_ms,
+                               uint64_t now_ms) {
+    if (!graph) return NULL;
+
+    GraphExpiry *expiry = (GraphExpiry*)MALLOC_S(sizeof(GraphExpiry));
+    if (!expiry) return NULL;
+
+    expiry->table = (ExpiryRecord**)CALLOC_S(EXPIRY_TABLE_INIT_CAPACITY, sizeof(ExpiryRecord*));
+    if (!expiry->table) {
+        FREE_S(expiry);
+        return NULL;
+    }
+    expiry->mask = EXPIRY_TABLE_INIT_CAPACITY - 1;
+    expiry->count = 0;
+    expiry->graph = graph;
+    expiry->node_timeout_ms = node_timeout_ms;
+    expiry->edge_timeout_ms = edge_timeout_ms;
+    timer_wheel_init(&expiry->wheel, GRAPH_EXPIRY_TICK_MS, now_ms);
+    MEM_POOL_INIT(&expiry->pool, "expiry_record", ExpiryRecord, 256, false);
+    GraphBatchInit(&expiry->departed);
+
+    for (int i = 0; i < graph->slot_count; i++) {
+        GraphNode *node = graph->nodes[i];
+        if (!node) continue;
+
+        if (!(node->flags & NODE_FLAG_LOCAL)) {
+            GraphExpiryTouchNode(expiry, node->id, now_ms);
+        }
+        for (int j = 0; j < node->neighbor_count; j++) {
+            int to_id = graph->nodes[node->edges[j].slot]->id;
+            if (graph->directed || node->id <= to_id) {
+                GraphExpiryTouchEdge(expiry, node->id, to_id, now_ms);
+            }
+        }
+    }
+    return expiry;
+}
+
+/* Timers of other owners still on the wheel must be cancelled first */
+void GraphExpiryDestroy(GraphExpiry *expiry) {
+    if (!expiry) return;
+
+    GraphBatchFree(&expiry->departed);
+    mem_pool_destroy(&expiry->pool);
+    FREE_S(expiry->table);
+    FREE_S(expiry);
+}
+
+/* Heartbeat from a node, starts tracking it if needed */
+bool GraphExpiryTouchNode(GraphExpiry *expiry, int node_id, uint64_t now_ms) {
+    if (!expiry) return false;
+
+    return ExpiryArm(expiry, node_id, GRAPH_INVALID_ID, now_ms + expiry->node_timeout_ms);
+}
+
+bool GraphExpiryTouchEdge(GraphExpiry *expiry, int from_id, int to_id, uint64_t now_ms) {
+    if (!expiry) return false;
+
+    // 无向图中 (a, b) 与 (b, a) 共用一个定时器
+    if (!expiry->graph->directed && from_id > to_id) {
+        SWAP_VAR(int, from_id, to_id);
+    }
+    return ExpiryArm(expiry, from_id, to_id, now_ms + expiry->edge_timeout_ms);
+}
+
+/* Stop tracking, e.g. after an explicit leave */
+void GraphExpiryForgetNode(GraphExpiry *expiry, int node_id) {
+    if (!expiry) return;
+
+    int index = ExpiryFindIndex(expiry, node_id, GRAPH_INVALID_ID);
+    if (index >= 0) {
+        ExpiryRecordFree(expiry, index);
+    }
+}
+
+void GraphExpiryForgetEdge(GraphExpiry *expiry, int from_id, int to_id) {
+    if (!expiry) return;
+
+    if (!expiry->graph->directed && from_id > to_id) {
+        SWAP_VAR(int, from_id, to_id);
+    }
+    int index = ExpiryFindIndex(expiry, from_id, to_id);
+    if (index >= 0) {
+        ExpiryRecordFree(expiry, index);
+    }
+}
+
+/*
+ * Run due timers and remove everything that timed out in one batch.
+ * Returns the number of nodes and edges removed, -1 on error.
+ */
+int GraphExpiryAdvance(GraphExpiry *expiry, uint64_t now_ms) {
+    if (!expiry) return -1;
+
+    timer_wheel_advance(&expiry->wheel, now_ms, expiry);
+    if (expiry->departed.count == 0) return 0;
+
+    // 边先于节点删除；节点删除时相关的边一并移除，其定时器到期时删除落空
+    return GraphApplyBatch(expiry->graph, &expiry->departed);
+}
@@ -21,13 +21,193 @@
  * @file graph.c
  * @author kkdc <1557655177@qq.com>
  */
- 
- #include "discovery/graph.h"
 
-/* Global */
+#include "discovery/graph.h"
+#include "discovery/snapshot.h"
+#include "discovery/journal.h"
+#include "discovery/metrics.h"
+#include "util/bitset.h"
 
-static Graph* g_dev_topology = NULL;
-static GraphNode* g_cur_dev = NULL;
+// Id 索引
+#define GRAPH_INDEX_INIT_CAPACITY 16
+
+static inline unsigned int GraphIndexHash(int id) {
+    uint32_t h = (uint32_t)id;
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+static bool GraphIndexInit(GraphIndex *index, unsigned int capacity) {
+    index->entries = (GraphIndexEntry*)MALLOC_S(capacity * sizeof(GraphIndexEntry));
+    if (!index->entries) return false;
+
+    for (unsigned int i = 0; i < capacity; i++) {
+        index->entries[i].id = GRAPH_INVALID_ID;
+        index->entries[i].slot = GRAPH_INVALID_SLOT;
+    }
+    index->mask = capacity - 1;
+    index->count = 0;
+    return true;
+}
+
+int GraphIndexFind(const GraphIndex *index, int id) {
+    unsigned int i = GraphIndexHash(id) & index->mask;
+    while (index->entries[i].id != GRAPH_INVALID_ID) {
+        if (index->entries[i].id == id) {
+            return index->entries[i].slot;
+        }
+        i = (i + 1) & index->mask;
+    }
+    return GRAPH_INVALID_SLOT;
+}
+
+static void GraphIndexPut(GraphIndex *index, int id, int slot) {
+    unsigned int i = GraphIndexHash(id) & index->mask;
+    while (index->entries[i].id != GRAPH_INVALID_ID && index->entries[i].id != id) {
+        i = (i + 1) & index->mask;
+    }
+    if (index->entries[i].id == GRAPH_INVALID_ID) {
+        index->count++;
+    }
+    index->entries[i].id = id;
+    index->entries[i].slot = slot;
+}
+
+static bool GraphIndexGrow(GraphIndex *index) {
+    GraphIndex grown;
+    if (!GraphIndexInit(&grown, (index->mask + 1) * 2)) return false;
+
+    for (unsigned int i = 0; i <= index->mask; i++) {
+        if (index->entries[i].id != GRAPH_INVALID_ID) {
+            GraphIndexPut(&grown, index->entries[i].id, index->entries[i].slot);
+        }
+    }
+    FREE_S(index->entries);
+    *index = grown;
+    return true;
+}
+
+// 删除后将探测链上的后续元素回移，不留墓碑
+static void GraphIndexErase(GraphIndex *index, int id) {
+    unsigned int i = GraphIndexHash(id) & index->mask;
+    while (index->entries[i].id != id) {
+        if (index->entries[i].id == GRAPH_INVALID_ID) return;
+        i = (i + 1) & index->mask;
+    }
+
+    unsigned int j = i;
+    while (true) {
+        j = (j + 1) & index->mask;
+        if (index->entries[j].id == GRAPH_INVALID_ID) break;
+
+        // 元素的理想位置 k 不在 (i, j] 区间内时才能回移到 i
+        unsigned int k = GraphIndexHash(index->entries[j].id) & index->mask;
+        if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) continue;
+
+        index->entries[i] = index->entries[j];
+        i = j;
+    }
+    index->entries[i].id = GRAPH_INVALID_ID;
+    index->entries[i].slot = GRAPH_INVALID_SLOT;
+    index->count--;
+}
+
+// 邻接表工具
+static int NodeFindEdge(const GraphNode *node, int slot) {
+    for (int i = 0; i < node->neighbor_count; i++) {
+        if (node->edges[i].slot == slot) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool NodeRemoveEdgeTo(Graph *graph, GraphNode *node, int slot) {
+    int index = NodeFindEdge(node, slot);
+    if (index < 0) return false;
+
+    EdgeMetricsRelease(graph->metrics, node->edges[index].metric);
+    // 将最后一个元素移到当前位置
+    node->edges[index] = node->edges[node->neighbor_count - 1];
+    node->neighbor_count--;
+    return true;
+}
+
+// 反向邻接：有向图中记录指向本节点的槽位，删除节点时只需访问受影响的邻居
+static bool NodeAddInEdge(GraphNode *node, int slot) {
+    if (node->in_count >= node->in_capacity) {
+        int new_capacity = node->in_capacity ? node->in_capacity * 2 : 4;
+        int *new_in_slots = (int*)RELLOC_S(node->in_slots, new_capacity * sizeof(int));
+        if (!new_in_slots) return false;
+
+        node->in_slots = new_in_slots;
+        node->in_capacity = new_capacity;
+    }
+    node->in_slots[node->in_count++] = slot;
+    return true;
+}
+
+static void NodeRemoveInEdge(GraphNode *node, int slot) {
+    for (int i = 0; i < node->in_count; i++) {
+        if (node->in_slots[i] == slot) {
+            node->in_slots[i] = node->in_slots[--node->in_count];
+            return;
+        }
+    }
+}
+
+// 邻接数组按容量分级从 slab 池分配，超过最大级别时退回 malloc
+static int EdgeClass(int capacity) {
+    int cls = 0;
+    for (int cap = GRAPH_EDGE_MIN_CAPACITY; cls < GRAPH_EDGE_CLASSES; cls++, cap <<= 1) {
+        if (cap == capacity) return cls;
+    }
+    return -1;
+}
+
+static GraphEdge* GraphEdgesAlloc(Graph *graph, int capacity) {
+    int cls = EdgeClass(capacity);
+    if (cls < 0) return (GraphEdge*)MALLOC_S(capacity * sizeof(GraphEdge));
+    return (GraphEdge*)mem_pool_alloc(&graph->edge_pools[cls]);
+}
+
+static void GraphEdgesFree(Graph *graph, GraphEdge *edges, int capacity) {
+    int cls = EdgeClass(capacity);
+    if (cls < 0) {
+        free(edges);
+    } else {
+        mem_pool_free(&graph->edge_pools[cls], edges);
+    }
+}
+
+static bool NodeReserveEdges(Graph *graph, GraphNode *node, int count) {
+    int needed = node->neighbor_count + count;
+    if (needed <= node->capacity) return true;
+
+    int new_capacity = node->capacity * 2;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    GraphEdge *new_edges;
+
+    if (EdgeClass(node->capacity) < 0) {
+        new_edges = (GraphEdge*)RELLOC_S(node->edges, new_capacity * sizeof(GraphEdge));
+        if (!new_edges) return false;
+    } else {
+        new_edges = GraphEdgesAlloc(graph, new_capacity);
+        if (!new_edges) return false;
+        memcpy(new_edges, node->edges, node->neighbor_count * sizeof(GraphEdge));
+        GraphEdgesFree(graph, node->edges, node->capacity);
+    }
+
+    node->edges = new_edges;
+    node->capacity = new_capacity;
+    return true;
+}
 
 // Graph create and destory
 Graph* GraphCreate(bool directed) {
@@ -35,122 +215,363 @@ Graph* GraphCreate(bool directed) {
     if (!graph) return NULL;
     
     graph->nodes = (GraphNode**)MALLOC_S(10 * sizeof(GraphNode*));
+    graph->devices = (Device*)MALLOC_S(10 * sizeof(Device));
+    graph->free_slots = (int*)MALLOC_S(10 * sizeof(int));
+    if (!graph->nodes || !graph->devices || !graph->free_slots ||
+        !GraphIndexInit(&graph->index, GRAPH_INDEX_INIT_CAPACITY)) {
+        if (graph->nodes) FREE_S(graph->nodes);
+        if (graph->devices) FREE_S(graph->devices);
+        if (graph->free_slots) FREE_S(graph->free_slots);
+        FREE_S(graph);
+        return NULL;
+    }
     graph->node_count = 0;
+    graph->slot_count = 0;
+    graph->free_count = 0;
     graph->capacity = 10;
     graph->directed = directed;
+    graph->next_id = 1;
+    graph->version = 0;
+    graph->update_depth = 0;
+    graph->update_dirty = false;
+    graph->snapshot = NULL;
+    graph->journal = NULL;
+    graph->metrics = NULL;
+
+    MEM_POOL_INIT(&graph->node_pool, "graph_node", GraphNode, 256, false);
+    for (int i = 0, cap = GRAPH_EDGE_MIN_CAPACITY; i < GRAPH_EDGE_CLASSES; i++, cap <<= 1) {
+        mem_pool_init(&graph->edge_pools[i], "graph_edges", cap * sizeof(GraphEdge),
+                      _Alignof(GraphEdge), 128 / cap, false);
+    }
     
     return graph;
 }
 
+static void GraphNodeFree(Graph *graph, GraphNode *node) {
+    for (int i = 0; i < node->neighbor_count; i++) {
+        EdgeMetricsRelease(graph->metrics, node->edges[i].metric);
+    }
+    NodeRelease(GraphNodeDevice(graph, node));
+    GraphEdgesFree(graph, node->edges, node->capacity);
+    free(node->in_slots);
+    mem_pool_free(&graph->node_pool, node);
+}
+
 void GraphDestroy(Graph *graph) {
     if (!graph) return;
     
-    for (int i = 0; i < graph->node_count; i++) {
-        GraphNode *node = graph->nodes[i];
-        free(node->neighbors);
-        free(node->edge_data);
-        if (node->data.interfaces) {
-            free(node->data.interfaces);
+    for (int i = 0; i < graph->slot_count; i++) {
+        if (graph->nodes[i]) {
+            GraphNodeFree(graph, graph->nodes[i]);
         }
-        if (node->data.custom_data) {
-            free(node->data.custom_data);
-        }
-        free(node);
     }
     
+    GraphSnapshotDestroy(graph->snapshot);
+    GraphJournalDestroy(graph->journal);
+    EdgeMetricsDestroy(graph->metrics);
+    mem_pool_destroy(&graph->node_pool);
+    for (int i = 0; i < GRAPH_EDGE_CLASSES; i++) {
+        mem_pool_destroy(&graph->edge_pools[i]);
+    }
     free(graph->nodes);
+    free(graph->devices);
+    free(graph->free_slots);
+    free(graph->index.entries);
     free(graph);
 }
 
+/* Start recording changes, keeping the newest capacity deltas */
+bool GraphEnableJournal(Graph *graph, int capacity) {
+    if (!graph) return false;
+    if (graph->journal) return true;
+
+    graph->journal = GraphJournalCreate(capacity);
+    if (!graph->journal) return false;
+
+    // 启用前的变化没有记录，订阅者需从快照开始
+    graph->journal->lost_version = graph->version;
+    return true;
+}
+
+/* Group the following changes under a single version, calls may nest */
+void GraphBeginUpdate(Graph *graph) {
+    if (graph->update_depth++ == 0) {
+        graph->update_dirty = false;
+    }
+}
+
+void GraphEndUpdate(Graph *graph) {
+    if (--graph->update_depth == 0 && graph->update_dirty) {
+        graph->version++;
+    }
+}
+
+// 推进版本号，更新分组内所有变化共用下一个版本号
+static unsigned long GraphNextVersion(Graph *graph) {
+    if (graph->update_depth > 0) {
+        graph->update_dirty = true;
+        return graph->version + 1;
+    }
+    return ++graph->version;
+}
+
+// 记录一次变化：推进版本号并写入日志
+static void GraphRecord(Graph *graph, GraphDeltaType type, int from_id, int to_id, const EdgeData *edge) {
+    unsigned long version = GraphNextVersion(graph);
+    GraphJournalAppend(graph->journal, version, type, from_id, to_id, edge);
+}
+
 // 节点操作
-GraphNode* GraphAddNode(Graph *graph, Device data) {
-    if (!graph || graph->node_count >= graph->capacity) {
-        int new_capacity = graph->capacity * 2;
-        GraphNode **new_nodes = (GraphNode**)RELLOC_S(graph->nodes, new_capacity * sizeof(GraphNode*));
-        if (!new_nodes) return NULL;
-        
-        graph->nodes = new_nodes;
-        graph->capacity = new_capacity;
+static bool GraphReserveSlots(Graph *graph, int count) {
+    int needed = graph->slot_count + MAX(count - graph->free_count, 0);
+    if (needed <= graph->capacity) return true;
+
+    int new_capacity = graph->capacity * 2;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
     }
+
+    GraphNode **new_nodes = (GraphNode**)RELLOC_S(graph->nodes, new_capacity * sizeof(GraphNode*));
+    if (!new_nodes) return false;
+    graph->nodes = new_nodes;
+
+    Device *new_devices = (Device*)RELLOC_S(graph->devices, new_capacity * sizeof(Device));
+    if (!new_devices) return false;
+    graph->devices = new_devices;
+
+    int *new_free_slots = (int*)RELLOC_S(graph->free_slots, new_capacity * sizeof(int));
+    if (!new_free_slots) return false;
+    graph->free_slots = new_free_slots;
+
+    graph->capacity = new_capacity;
+    return true;
+}
+
+static bool GraphReserveIndex(Graph *graph, int count) {
+    // 负载因子保持在 1/2 以下
+    while ((unsigned int)(graph->index.count + count) * 2 > graph->index.mask + 1) {
+        if (!GraphIndexGrow(&graph->index)) return false;
+    }
+    return true;
+}
+
+/* Make room for count more nodes without reallocating on each add */
+bool GraphReserve(Graph *graph, int count) {
+    if (!graph || count <= 0) return graph != NULL;
+
+    return GraphReserveSlots(graph, count) && GraphReserveIndex(graph, count);
+}
+
+void NodeRelease(Device *device) {
+    if (device->ifaces) {
+        free(device->ifaces);
+    }
+    if (device->data) {
+        free(device->data);
+    }
+    memset(device, 0, sizeof(Device));
+}
+
+GraphNode* GraphAddNodeWithId(Graph *graph, int node_id, Device data) {
+    if (!graph || node_id <= GRAPH_INVALID_ID) return NULL;
+    if (GraphIndexFind(&graph->index, node_id) != GRAPH_INVALID_SLOT) return NULL;
+    if (!GraphReserve(graph, 1)) return NULL;
     
-    GraphNode *new_node = (GraphNode*)MALLOC_S(sizeof(GraphNode));
+    GraphNode *new_node = POOL_ALLOC_S(&graph->node_pool, GraphNode);
     if (!new_node) return NULL;
     
-    static int next_id = 1;
-    new_node->id = next_id++;
-    new_node->data = data;
-    new_node->neighbors = (GraphNode**)MALLOC_S(5 * sizeof(GraphNode*));
-    new_node->edge_data = (EdgeData**)MALLOC_S(5 * sizeof(EdgeData*));
+    new_node->edges = GraphEdgesAlloc(graph, GRAPH_EDGE_MIN_CAPACITY);
+    if (!new_node->edges) {
+        POOL_FREE_S(&graph->node_pool, new_node);
+        return NULL;
+    }
+    new_node->id = node_id;
+    new_node->slot = graph->free_count > 0 ? graph->free_slots[--graph->free_count] : graph->slot_count++;
+    new_node->flags = 0;
     new_node->neighbor_count = 0;
-    new_node->capacity = 5;
+    new_node->capacity = GRAPH_EDGE_MIN_CAPACITY;
+    new_node->in_slots = NULL;
+    new_node->in_count = 0;
+    new_node->in_capacity = 0;
     
-    graph->nodes[graph->node_count++] = new_node;
+    graph->nodes[new_node->slot] = new_node;
+    graph->devices[new_node->slot] = data;
+    graph->node_count++;
+    GraphIndexPut(&graph->index, new_node->id, new_node->slot);
+    if (node_id >= graph->next_id) {
+        graph->next_id = node_id + 1;
+    }
+    GraphRecord(graph, GRAPH_DELTA_NODE_ADD, node_id, GRAPH_INVALID_ID, NULL);
     return new_node;
 }
 
+GraphNode* GraphAddNode(Graph *graph, Device data) {
+    if (!graph) return NULL;
+
+    while (GraphIndexFind(&graph->index, graph->next_id) != GRAPH_INVALID_SLOT) {
+        graph->next_id++;
+    }
+    return GraphAddNodeWithId(graph, graph->next_id, data);
+}
+
+/* Replace the descriptive data of an existing node, the old data is released.
+ * Also confirms a node restored from disk */
+bool GraphUpdateNode(Graph *graph, int node_id, Device data) {
+    GraphNode *node = GraphGetNode(graph, node_id);
+    if (!node) return false;
+
+    Device *device = GraphNodeDevice(graph, node);
+    if (device->ifaces == data.ifaces) device->ifaces = NULL;
+    if (device->data == data.data) device->data = NULL;
+    NodeRelease(device);
+    *device = data;
+    node->flags &= ~NODE_FLAG_STALE;
+    GraphRecord(graph, GRAPH_DELTA_NODE_UPDATE, node_id, GRAPH_INVALID_ID, NULL);
+    return true;
+}
+
 bool GraphRemoveNode(Graph *graph, int node_id) {
     if (!graph) return false;
     
     // 查找节点
-    int index = -1;
-    GraphNode *target = NULL;
-    for (int i = 0; i < graph->node_count; i++) {
-        if (graph->nodes[i]->id == node_id) {
-            index = i;
-            target = graph->nodes[i];
-            break;
-        }
-    }
-    
+    GraphNode *target = GraphGetNode(graph, node_id);
     if (!target) return false;
     
-    // 从所有邻居中移除该节点
-    for (int i = 0; i < graph->node_count; i++) {
-        GraphNode *node = graph->nodes[i];
-        for (int j = 0; j < node->neighbor_count; j++) {
-            if (node->neighbors[j] == target) {
-                // 移除边
-                free(node->edge_data[j]);
-                // 将最后一个元素移到当前位置
-                node->neighbors[j] = node->neighbors[node->neighbor_count - 1];
-                node->edge_data[j] = node->edge_data[node->neighbor_count - 1];
-                node->neighbor_count--;
-                break;
+    // 只访问相邻节点：无向图的反向边即出边镜像，有向图使用反向邻接表
+    int slot = target->slot;
+    if (graph->directed) {
+        for (int i = 0; i < target->in_count; i++) {
+            if (target->in_slots[i] != slot) {
+                NodeRemoveEdgeTo(graph, graph->nodes[target->in_slots[i]], slot);
+            }
+        }
+        for (int j = 0; j < target->neighbor_count; j++) {
+            if (target->edges[j].slot != slot) {
+                NodeRemoveInEdge(graph->nodes[target->edges[j].slot], slot);
+            }
+        }
+    } else {
+        for (int j = 0; j < target->neighbor_count; j++) {
+            if (target->edges[j].slot != slot) {
+                NodeRemoveEdgeTo(graph, graph->nodes[target->edges[j].slot], slot);
             }
         }
     }
     
-    // 释放节点资源
-    free(target->neighbors);
-    free(target->edge_data);
-    if (target->data.interfaces) {
-        free(target->data.interfaces);
-    }
-    if (target->data.custom_data) {
-        free(target->data.custom_data);
-    }
-    free(target);
-    
-    // 将最后一个节点移到当前位置
-    graph->nodes[index] = graph->nodes[graph->node_count - 1];
+    // 释放槽位，其他节点的槽位保持不变
+    GraphIndexErase(&graph->index, node_id);
+    graph->nodes[slot] = NULL;
+    graph->free_slots[graph->free_count++] = slot;
     graph->node_count--;
+    GraphRecord(graph, GRAPH_DELTA_NODE_REMOVE, node_id, GRAPH_INVALID_ID, NULL);
+
+    // 释放节点资源
+    GraphNodeFree(graph, target);
     
     return true;
 }
 
+/* Drop every node a heartbeat has not confirmed since it was restored */
+int GraphRemoveStale(Graph *graph) {
+    if (!graph) return 0;
+
+    int removed = 0;
+    GraphBeginUpdate(graph);
+    for (int i = 0; i < graph->slot_count; i++) {
+        GraphNode *node = graph->nodes[i];
+        if (node && (node->flags & NODE_FLAG_STALE) && GraphRemoveNode(graph, node->id)) {
+            removed++;
+        }
+    }
+    GraphEndUpdate(graph);
+    return removed;
+}
+
+/* Make room for count more edges out of node_id */
+bool GraphReserveEdges(Graph *graph, int node_id, int count) {
+    GraphNode *node = GraphGetNode(graph, node_id);
+    if (!node) return false;
+
+    return NodeReserveEdges(graph, node, count);
+}
+
 GraphNode* GraphGetNode(Graph *graph, int node_id) {
     if (!graph) return NULL;
     
-    for (int i = 0; i < graph->node_count; i++) {
-        if (graph->nodes[i]->id == node_id) {
-            return graph->nodes[i];
+    int slot = GraphIndexFind(&graph->index, node_id);
+    return slot == GRAPH_INVALID_SLOT ? NULL : graph->nodes[slot];
+}
+
+Device* GraphGetDevice(Graph *graph, int node_id) {
+    GraphNode *node = GraphGetNode(graph, node_id);
+    return node ? GraphNodeDevice(graph, node) : NULL;
+}
+
+// 描述字段均为驻留句柄，逐项比较整数即可
+static inline bool DeviceMatches(const Device *device, const DeviceFilter *filter) {
+    return (!filter->platform || device->platform == filter->platform) &&
+           (!filter->subplatform || device->subplatform == filter->subplatform) &&
+           (!filter->hostname || device->hostname == filter->hostname) &&
+           (!filter->os_version || device->os_version == filter->os_version) &&
+           (!filter->architecture || device->architecture == filter->architecture);
+}
+
+/* Write the ids of up to max matching nodes, returns the total number of matches */
+int GraphFilterNodes(Graph *graph, const DeviceFilter *filter, int *ids, int max) {
+    if (!graph || !filter) return 0;
+
+    int matches = 0;
+    for (int i = 0; i < graph->slot_count; i++) {
+        if (graph->nodes[i] && DeviceMatches(&graph->devices[i], filter)) {
+            if (matches < max) {
+                ids[matches] = graph->nodes[i]->id;
+            }
+            matches++;
         }
     }
-    
-    return NULL;
+    return matches;
+}
+
+int GraphGetSlot(Graph *graph, int node_id) {
+    if (!graph) return GRAPH_INVALID_SLOT;
+
+    return GraphIndexFind(&graph->index, node_id);
 }
 
 // 边操作
+// 插入或更新单向邻接，created 返回是否新建
+static bool NodeLinkEdge(Graph *graph, GraphNode *from, GraphNode *to, const EdgeData *data, bool *created) {
+    // 检查是否已存在边
+    int index = NodeFindEdge(from, to->slot);
+    if (index >= 0) {
+        // 更新现有边数据
+        from->edges[index].data = *data;
+        *created = false;
+        return true;
+    }
+
+    // 需要扩容
+    if (!NodeReserveEdges(graph, from, 1)) return false;
+
+    if (graph->directed && !NodeAddInEdge(to, from->slot)) return false;
+
+    // 添加新边，边数据直接存放在邻接数组中
+    from->edges[from->neighbor_count].slot = to->slot;
+    from->edges[from->neighbor_count].metric = EDGE_METRIC_NONE;
+    from->edges[from->neighbor_count].data = *data;
+    from->neighbor_count++;
+    *created = true;
+    return true;
+}
+
+static bool NodeUnlinkEdge(Graph *graph, GraphNode *from, GraphNode *to) {
+    if (!NodeRemoveEdgeTo(graph, from, to->slot)) return false;
+    if (graph->directed) {
+        NodeRemoveInEdge(to, from->slot);
+    }
+    return true;
+}
+
 bool GraphAddEdge(Graph *graph, int from_id, int to_id, EdgeData data) {
     if (!graph) return false;
     
@@ -158,42 +579,21 @@ bool GraphAddEdge(Graph *graph, int from_id, int to_id, EdgeData data) {
     GraphNode *to = GraphGetNode(graph, to_id);
     if (!from || !to) return false;
     
-    // 检查是否已存在边
-    for (int i = 0; i < from->neighbor_count; i++) {
-        if (from->neighbors[i] == to) {
-            // 更新现有边数据
-            *(from->edge_data[i]) = data;
-            return true;
-        }
-    }
-    
-    // 需要扩容
-    if (from->neighbor_count >= from->capacity) {
-        int new_capacity = from->capacity * 2;
-        GraphNode **new_neighbors = (GraphNode**)RELLOC_S(from->neighbors, new_capacity * sizeof(GraphNode*));
-        EdgeData **new_edge_data = (EdgeData**)RELLOC_S(from->edge_data, new_capacity * sizeof(EdgeData*));
-        
-        if (!new_neighbors || !new_edge_data) return false;
-        
-        from->neighbors = new_neighbors;
-        from->edge_data = new_edge_data;
-        from->capacity = new_capacity;
-    }
-    
-    // 添加新边
-    EdgeData *new_edge_data = (EdgeData*)MALLOC_S(sizeof(EdgeData));
-    if (!new_edge_data) return false;
-    
-    *new_edge_data = data;
-    from->neighbors[from->neighbor_count] = to;
-    from->edge_data[from->neighbor_count] = new_edge_data;
-    from->neighbor_count++;
+    bool created;
+    if (!NodeLinkEdge(graph, from, to, &data, &created)) return false;
     
-    // 如果是无向图，添加反向边
-    if (!graph->directed) {
-        GraphAddEdge(graph, to_id, from_id, data);
+    // 如果是无向图，同步反向边，失败时撤销正向边保持对称
+    if (!graph->directed && from != to) {
+        bool mirrored;
+        if (!NodeLinkEdge(graph, to, from, &data, &mirrored)) {
+            if (created) NodeUnlinkEdge(graph, from, to);
+            return false;
+        }
+        created = created || mirrored;
     }
     
+    // 无向边只记录一次
+    GraphRecord(graph, created ? GRAPH_DELTA_EDGE_ADD : GRAPH_DELTA_EDGE_UPDATE, from_id, to_id, &data);
     return true;
 }
 
@@ -204,26 +604,18 @@ bool GraphRemoveEdge(Graph *graph, int from_id, int to_id) {
     GraphNode *to = GraphGetNode(graph, to_id);
     if (!from || !to) return false;
     
-    for (int i = 0; i < from->neighbor_count; i++) {
-        if (from->neighbors[i] == to) {
-            free(from->edge_data[i]);
-            // 将最后一个元素移到当前位置
-            from->neighbors[i] = from->neighbors[from->neighbor_count - 1];
-            from->edge_data[i] = from->edge_data[from->neighbor_count - 1];
-            from->neighbor_count--;
-            
-            // 如果是无向图，移除反向边
-            if (!graph->directed) {
-                GraphRemoveEdge(graph, to_id, from_id);
-            }
-            
-            return true;
-        }
+    if (!NodeUnlinkEdge(graph, from, to)) return false;
+    
+    // 如果是无向图，移除反向边
+    if (!graph->directed && from != to) {
+        NodeUnlinkEdge(graph, to, from);
     }
     
-    return false;
+    GraphRecord(graph, GRAPH_DELTA_EDGE_REMOVE, from_id, to_id, NULL);
+    return true;
 }
 
+/* The returned pointer is valid until the next edge is added to from_id */
 EdgeData* GraphGetEdge(Graph *graph, int from_id, int to_id) {
     if (!graph) return NULL;
     
@@ -231,58 +623,279 @@ EdgeData* GraphGetEdge(Graph *graph, int from_id, int to_id) {
     GraphNode *to = GraphGetNode(graph, to_id);
     if (!from || !to) return NULL;
     
-    for (int i = 0; i < from->neighbor_count; i++) {
-        if (from->neighbors[i] == to) {
-            return from->edge_data[i];
+    int index = NodeFindEdge(from, to->slot);
+    return index >= 0 ? &from->edges[index].data : NULL;
+}
+
+// 边度量：探测样本进入边的通道，聚合后才推进版本号，路由使用平滑值
+static GraphEdge* GraphFindEdgeRecord(Graph *graph, int from_id, int to_id) {
+    GraphNode *from = GraphGetNode(graph, from_id);
+    GraphNode *to = GraphGetNode(graph, to_id);
+    if (!from || !to) return NULL;
+
+    int index = NodeFindEdge(from, to->slot);
+    return index >= 0 ? &from->edges[index] : NULL;
+}
+
+static bool EdgeRecordSample(Graph *graph, GraphEdge *edge, float latency, float packet_loss,
+                             unsigned int bandwidth) {
+    if (edge->metric == EDGE_METRIC_NONE) {
+        edge->metric = EdgeMetricsAcquire(graph->metrics);
+        if (edge->metric == EDGE_METRIC_NONE) return false;
+    }
+    EdgeMetricsRecord(graph->metrics, edge->metric, latency, packet_loss, (float)bandwidth);
+
+    // 原始数据保留最近一次探测结果
+    edge->data.latency = latency;
+    edge->data.packet_loss = packet_loss;
+    edge->data.bandwidth = bandwidth;
+    edge->data.last_communication = time(NULL);
+    return true;
+}
+
+/* Record a probe, takes effect at the next GraphAggregateMetrics */
+bool GraphEdgeSample(Graph *graph, int from_id, int to_id, float latency, float packet_loss,
+                     unsigned int bandwidth) {
+    if (!graph) return false;
+
+    GraphEdge *edge = GraphFindEdgeRecord(graph, from_id, to_id);
+    if (!edge) return false;
+
+    if (!graph->metrics) {
+        graph->metrics = EdgeMetricsCreate(EDGE_METRIC_ALPHA);
+        if (!graph->metrics) return false;
+    }
+
+    if (!EdgeRecordSample(graph, edge, latency, packet_loss, bandwidth)) return false;
+
+    // 无向图两个方向各有一条记录，同步采样
+    if (!graph->directed && from_id != to_id) {
+        GraphEdge *mirror = GraphFindEdgeRecord(graph, to_id, from_id);
+        if (mirror && !EdgeRecordSample(graph, mirror, latency, packet_loss, bandwidth)) return false;
+    }
+    return true;
+}
+
+/* Fold pending samples into the smoothed metrics, returns the number of updated lanes */
+int GraphAggregateMetrics(Graph *graph) {
+    if (!graph) return 0;
+
+    int updated = EdgeMetricsAggregate(graph->metrics);
+    // 度量变化不写日志，只让快照和路由视图失效
+    if (updated > 0) {
+        GraphNextVersion(graph);
+    }
+    return updated;
+}
+
+bool GraphGetEdgeStats(Graph *graph, int from_id, int to_id, EdgeStats *stats) {
+    if (!graph || !stats) return false;
+
+    GraphEdge *edge = GraphFindEdgeRecord(graph, from_id, to_id);
+    if (!edge) return false;
+
+    EdgeMetricsStats(graph->metrics, edge->metric, stats);
+    if (!EdgeMetricsReady(graph->metrics, edge->metric)) {
+        stats->latency = edge->data.latency;
+        stats->packet_loss = edge->data.packet_loss;
+        stats->bandwidth = edge->data.bandwidth;
+    }
+    return true;
+}
+
+// 遍历，访问标记使用按槽位的位图，栈和队列来自线程私有 arena
+void GraphDFS(Graph *graph, int start_id, void (*visit)(GraphNode*)) {
+    GraphNode *start = GraphGetNode(graph, start_id);
+    if (!start || !visit) return;
+
+    MemArena *scratch = mem_thread_arena();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    Bitset visited;
+    int *stack = ARENA_ALLOC_S(scratch, graph->slot_count, int);
+    int *cursor = ARENA_ALLOC_S(scratch, graph->slot_count, int);
+    if (!bitset_arena_init(&visited, scratch, graph->slot_count) || !stack || !cursor) {
+        mem_arena_release(scratch, mark);
+        return;
+    }
+
+    // 显式栈：每层记录下一个待访问的边
+    int top = 0;
+    stack[top] = start->slot;
+    cursor[top] = 0;
+    bitset_set(&visited, start->slot);
+    visit(start);
+
+    while (top >= 0) {
+        GraphNode *node = graph->nodes[stack[top]];
+        if (cursor[top] == node->neighbor_count) {
+            top--;
+            continue;
         }
+
+        int next = node->edges[cursor[top]++].slot;
+        if (bitset_test_and_set(&visited, next)) continue;
+
+        visit(graph->nodes[next]);
+        top++;
+        stack[top] = next;
+        cursor[top] = 0;
     }
-    
-    return NULL;
+
+    mem_arena_release(scratch, mark);
+}
+
+void GraphBFS(Graph *graph, int start_id, void (*visit)(GraphNode*)) {
+    GraphNode *start = GraphGetNode(graph, start_id);
+    if (!start || !visit) return;
+
+    MemArena *scratch = mem_thread_arena();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    Bitset visited;
+    int *queue = ARENA_ALLOC_S(scratch, graph->slot_count, int);
+    if (!bitset_arena_init(&visited, scratch, graph->slot_count) || !queue) {
+        mem_arena_release(scratch, mark);
+        return;
+    }
+
+    int head = 0, tail = 0;
+    queue[tail++] = start->slot;
+    bitset_set(&visited, start->slot);
+
+    while (head < tail) {
+        GraphNode *node = graph->nodes[queue[head++]];
+        visit(node);
+
+        for (int i = 0; i < node->neighbor_count; i++) {
+            int next = node->edges[i].slot;
+            if (!bitset_test_and_set(&visited, next)) {
+                queue[tail++] = next;
+            }
+        }
+    }
+
+    mem_arena_release(scratch, mark);
+}
+
+/*
+ * Fewest-hops path from start_id to end_id. On success *path receives a
+ * MALLOC_S'd array of node ids that the caller frees, and the number of
+ * nodes is returned. Returns 0 when end_id is unreachable.
+ */
+int GraphShortestPath(Graph *graph, int start_id, int end_id, int **path) {
+    GraphNode *start = GraphGetNode(graph, start_id);
+    GraphNode *end = GraphGetNode(graph, end_id);
+    if (!start || !end || !path) return 0;
+
+    MemArena *scratch = mem_thread_arena();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    Bitset visited;
+    int *queue = ARENA_ALLOC_S(scratch, graph->slot_count, int);
+    int *previous = ARENA_ALLOC_S(scratch, graph->slot_count, int);
+    if (!bitset_arena_init(&visited, scratch, graph->slot_count) || !queue || !previous) {
+        mem_arena_release(scratch, mark);
+        return 0;
+    }
+
+    int head = 0, tail = 0;
+    queue[tail++] = start->slot;
+    previous[start->slot] = -1;
+    bitset_set(&visited, start->slot);
+
+    while (head < tail && !bitset_test(&visited, end->slot)) {
+        GraphNode *node = graph->nodes[queue[head++]];
+        for (int i = 0; i < node->neighbor_count; i++) {
+            int next = node->edges[i].slot;
+            if (!bitset_test_and_set(&visited, next)) {
+                previous[next] = node->slot;
+                queue[tail++] = next;
+            }
+        }
+    }
+
+    int length = 0;
+    if (bitset_test(&visited, end->slot)) {
+        for (int slot = end->slot; slot != -1; slot = previous[slot]) {
+            length++;
+        }
+
+        *path = (int*)MALLOC_S(length * sizeof(int));
+        if (*path) {
+            int i = length;
+            for (int slot = end->slot; slot != -1; slot = previous[slot]) {
+                (*path)[--i] = graph->nodes[slot]->id;
+            }
+        } else {
+            length = 0;
+        }
+    }
+
+    mem_arena_release(scratch, mark);
+    return length;
 }
 
 // 节点数据操作
-void NodeInit(Device *data, Platform platform, SubPlatType subplatform) {
+/* Descriptive strings are interned, NULL leaves a field empty */
+void NodeInit(Device *data, Platform platform, SubPlatType subplatform,
+              const char *hostname, const char *os_version, const char *architecture) {
     memset(data, 0, sizeof(Device));
     data->platform = platform;
     data->subplatform = subplatform;
-    data->interface_count = 0;
-    data->interfaces = NULL;
+    data->hostname = str_intern(hostname);
+    data->os_version = str_intern(os_version);
+    data->architecture = str_intern(architecture);
+    data->iface_count = 0;
+    data->ifaces = NULL;
+}
+
+// 解析地址，优先使用 IPv4
+static bool IpFromString(IPAddress *ip, const char *ip_v4, const char *ip_v6) {
+    IPAddress parsed;
+    memset(&parsed, 0, sizeof(parsed));
+    if (ip_v4 && *ip_v4 && inet_pton(AF_INET, ip_v4, &parsed.address) == 1) {
+        parsed.family = AF_INET;
+    } else if (ip_v6 && *ip_v6 && inet_pton(AF_INET6, ip_v6, &parsed.address) == 1) {
+        parsed.family = AF_INET6;
+    } else {
+        return false;
+    }
+    *ip = parsed;
+    return true;
 }
 
 void NodeAddInterface(Device *data, const char *name, const char *ip_v4, const char *ip_v6, 
                        const char *mac, unsigned int mtu) {
     if (!data) return;
     
-    // 分配或重新分配接口数组
+    // 分配或重新分配接口数组，数组移动后保持当前使用的接口
+    int used = data->iface ? (int)(data->iface - data->ifaces) : -1;
     NetworkInterface *new_interfaces = (NetworkInterface*)RELLOC_S(
-        data->interfaces, 
-        (data->interface_count + 1) * sizeof(NetworkInterface)
+        data->ifaces, 
+        (data->iface_count + 1) * sizeof(NetworkInterface)
     );
     
     if (!new_interfaces) return;
     
-    data->interfaces = new_interfaces;
-    NetworkInterface *iface = &data->interfaces[data->interface_count];
+    data->ifaces = new_interfaces;
+    data->iface = used >= 0 ? &data->ifaces[used] : NULL;
+    NetworkInterface *iface = &data->ifaces[data->iface_count];
+    memset(iface, 0, sizeof(NetworkInterface));
     
-    strncpy(iface->name, name, sizeof(iface->name) - 1);
-    strncpy(iface->ip.v4, ip_v4, sizeof(iface->ip.v4) - 1);
-    strncpy(iface->ip.v6, ip_v6, sizeof(iface->ip.v6) - 1);
-    strncpy(iface->mac, mac, sizeof(iface->mac) - 1);
+    iface->name = str_intern(name);
+    IpFromString(&iface->ip, ip_v4, ip_v6);
+    if (mac) strncpy(iface->mac, mac, sizeof(iface->mac) - 1);
     iface->mtu = mtu;
     
-    data->interface_count++;
+    data->iface_count++;
 }
 
 void NodeSetPublicIp(Device *data, const char *ip_v4, const char *ip_v6) {
     if (!data) return;
-    if (ip_v4) strncpy(data->public_ip.v4, ip_v4, sizeof(data->public_ip.v4) - 1);
-    if (ip_v6) strncpy(data->public_ip.v6, ip_v6, sizeof(data->public_ip.v6) - 1);
+    IpFromString(&data->public_ip, ip_v4, ip_v6);
 }
 
 void NodeSetPrivateIp(Device *data, const char *ip_v4, const char *ip_v6) {
     if (!data) return;
-    if (ip_v4) strncpy(data->private_ip.v4, ip_v4, sizeof(data->private_ip.v4) - 1);
-    if (ip_v6) strncpy(data->private_ip.v6, ip_v6, sizeof(data->private_ip.v6) - 1);
+    IpFromString(&data->private_ip, ip_v4, ip_v6);
 }
 
 // 工具函数
@@ -315,28 +928,36 @@ const char* SubPlatformToString(SubPlatType subplatform) {
     }
 }
 
-void PrintNodeInfo(GraphNode *node) {
-    if (!node) return;
+static const char* IpToString(const IPAddress *ip, char *buf, socklen_t size) {
+    if (ip->family != AF_INET && ip->family != AF_INET6) return "-";
+    return inet_ntop(ip->family, &ip->address, buf, size) ? buf : "-";
+}
+
+void PrintNodeInfo(Graph *graph, GraphNode *node) {
+    if (!graph || !node) return;
+    
+    Device *device = GraphNodeDevice(graph, node);
+    char buf[INET6_ADDRSTRLEN];
     
     printf("Node ID: %d\n", node->id);
-    printf("Platform: %s\n", PlatformToString(node->data.platform));
-    printf("Subplatform: %s\n", SubPlatformToString(node->data.subplatform));
-    printf("Hostname: %s\n", node->data.hostname);
-    printf("OS Version: %s\n", node->data.os_version);
-    printf("Architecture: %s\n", node->data.architecture);
-    printf("Public IP: %s / %s\n", node->data.public_ip.v4, node->data.public_ip.v6);
-    printf("Private IP: %s / %s\n", node->data.private_ip.v4, node->data.private_ip.v6);
-    printf("Interfaces: %d\n", node->data.interface_count);
+    printf("Platform: %s\n", PlatformToString(device->platform));
+    printf("Subplatform: %s\n", SubPlatformToString(device->subplatform));
+    printf("Hostname: %s\n", str_get(device->hostname));
+    printf("OS Version: %s\n", str_get(device->os_version));
+    printf("Architecture: %s\n", str_get(device->architecture));
+    printf("Public IP: %s\n", IpToString(&device->public_ip, buf, sizeof(buf)));
+    printf("Private IP: %s\n", IpToString(&device->private_ip, buf, sizeof(buf)));
+    printf("Interfaces: %d\n", device->iface_count);
     
-    for (int i = 0; i < node->data.interface_count; i++) {
-        NetworkInterface *iface = &node->data.interfaces[i];
-        printf("  %s: %s/%s, MAC: %s, MTU: %u\n", 
-               iface->name, iface->ip.v4, iface->ip.v6, iface->mac, iface->mtu);
+    for (int i = 0; i < device->iface_count; i++) {
+        NetworkInterface *iface = &device->ifaces[i];
+        printf("  %s: %s, MAC: %s, MTU: %u\n", 
+               str_get(iface->name), IpToString(&iface->ip, buf, sizeof(buf)), iface->mac, iface->mtu);
     }
     
     printf("Neighbors: %d\n", node->neighbor_count);
     for (int i = 0; i < node->neighbor_count; i++) {
-        printf("  -> Node %d\n", node->neighbors[i]->id);
+        printf("  -> Node %d\n", graph->nodes[node->edges[i].slot]->id);
     }
     printf("\n");
 }
@@ -352,7 +973,6 @@ void PrintEdgeInfo(Graph *graph, int from_id, int to_id) {
     printf("  Bandwidth: %u Mbps\n", edge->bandwidth);
     printf("  Latency: %.2f ms\n", edge->latency);
     printf("  Packet Loss: %.2f%%\n", edge->packet_loss);
-    printf("  Protocol: %s\n", edge->protocol);
     printf("  Port: %u\n", edge->port);
     printf("  Traffic: %lu bytes\n", edge->traffic);
     printf("  Last Communication: %s", ctime(&edge->last_communication));
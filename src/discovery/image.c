@@ -0,0 +1,451 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file image.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/image.h"
+
+#define GRAPH_IMAGE_ALIGN 8
+
+/* Background write request */
+typedef struct GraphImageJob_ {
+    void *buf;
+    size_t size;
+    char path[];
+} GraphImageJob;
+
+static uint32_t g_crc32_table[256];
+static pthread_once_t g_crc32_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t g_image_write_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// 校验和，CRC-32 (IEEE)
+static void Crc32Init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320U & -(crc & 1));
+        }
+        g_crc32_table[i] = crc;
+    }
+}
+
+static uint32_t Crc32(const void *buf, size_t len) {
+    pthread_once(&g_crc32_once, Crc32Init);
+
+    const uint8_t *p = (const uint8_t*)buf;
+    uint32_t crc = 0xFFFFFFFFU;
+    while (len--) {
+        crc = g_crc32_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFU;
+}
+
+static size_t ImageAlign(size_t size) {
+    return (size + GRAPH_IMAGE_ALIGN - 1) & ~(size_t)(GRAPH_IMAGE_ALIGN - 1);
+}
+
+// 镜像中的字符串按定长字段存放，超长部分截断
+static void ImageCopyString(char *dst, size_t size, StrId id) {
+    size_t len = MIN(str_len(id), size - 1);
+    memcpy(dst, str_get(id), len);
+}
+
+static StrId ImageInternString(const char *src, size_t size) {
+    return str_intern_n(src, strnlen(src, size));
+}
+
+// 编码
+/* Serialize the graph into one malloc'ed buffer, the caller frees it */
+void* GraphImageEncode(Graph *graph, size_t *size) {
+    if (!graph || !size) return NULL;
+
+    uint32_t iface_count = 0, edge_count = 0;
+    for (int i = 0; i < graph->slot_count; i++) {
+        if (graph->nodes[i]) {
+            iface_count += graph->devices[i].iface_count;
+            edge_count += graph->nodes[i]->neighbor_count;
+        }
+    }
+
+    size_t node_offset = ImageAlign(sizeof(GraphImageHeader));
+    size_t iface_offset = node_offset + ImageAlign(graph->node_count * sizeof(GraphImageNode));
+    size_t edge_offset = iface_offset + ImageAlign(iface_count * sizeof(GraphImageIface));
+    size_t total = edge_offset + edge_count * sizeof(GraphImageEdge);
+
+    // 清零填充字节，相同拓扑得到相同的校验和
+    uint8_t *buf = (uint8_t*)CALLOC_S(1, total);
+    if (!buf) return NULL;
+
+    MemArena *scratch = mem_thread_arena();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    int *index = ARENA_ALLOC_S(scratch, MAX(graph->slot_count, 1), int);
+    if (!index) {
+        FREE_S(buf);
+        return NULL;
+    }
+
+    // 槽位 -> 节点表下标
+    for (int i = 0, n = 0; i < graph->slot_count; i++) {
+        index[i] = graph->nodes[i] ? n++ : -1;
+    }
+
+    GraphImageNode *nodes = (GraphImageNode*)(buf + node_offset);
+    GraphImageIface *ifaces = (GraphImageIface*)(buf + iface_offset);
+    GraphImageEdge *edges = (GraphImageEdge*)(buf + edge_offset);
+    uint32_t next_iface = 0, next_edge = 0;
+
+    for (int i = 0; i < graph->slot_count; i++) {
+        const GraphNode *node = graph->nodes[i];
+        if (!node) continue;
+
+        const Device *device = &graph->devices[i];
+        GraphImageNode *out = &nodes[index[i]];
+        out->id = node->id;
+        out->flags = node->flags;
+        out->platform = device->platform;
+        out->subplatform = device->subplatform;
+        ImageCopyString(out->hostname, sizeof(out->hostname), device->hostname);
+        ImageCopyString(out->os_version, sizeof(out->os_version), device->os_version);
+        ImageCopyString(out->architecture, sizeof(out->architecture), device->architecture);
+        out->memory = device->memory;
+        out->storage = device->storage;
+        out->public_ip = device->public_ip;
+        out->private_ip = device->private_ip;
+
+        out->iface_first = next_iface;
+        out->iface_count = device->iface_count;
+        out->iface_used = -1;
+        for (int k = 0; k < device->iface_count; k++) {
+            const NetworkInterface *iface = &device->ifaces[k];
+            GraphImageIface *dst = &ifaces[next_iface++];
+            ImageCopyString(dst->name, sizeof(dst->name), iface->name);
+            dst->ip = iface->ip;
+            memcpy(dst->mac, iface->mac, sizeof(dst->mac));
+            dst->mtu = iface->mtu;
+            if (device->iface == iface) {
+                out->iface_used = k;
+            }
+        }
+
+        out->edge_first = next_edge;
+        out->edge_count = node->neighbor_count;
+        for (int k = 0; k < node->neighbor_count; k++) {
+            const GraphEdge *edge = &node->edges[k];
+            GraphImageEdge *dst = &edges[next_edge++];
+            dst->to = index[edge->slot];
+            dst->bandwidth = edge->data.bandwidth;
+            dst->latency = edge->data.latency;
+            dst->packet_loss = edge->data.packet_loss;
+            dst->traffic = edge->data.traffic;
+            dst->last_communication = edge->data.last_communication;
+            dst->port = edge->data.port;
+            dst->utilize = edge->data.utilize;
+        }
+    }
+    mem_arena_release(scratch, mark);
+
+    GraphImageHeader *header = (GraphImageHeader*)buf;
+    header->magic = GRAPH_IMAGE_MAGIC;
+    header->format = GRAPH_IMAGE_FORMAT;
+    header->endian = GRAPH_IMAGE_ENDIAN;
+    header->size = total;
+    header->version = graph->version;
+    header->saved_at = time(NULL);
+    header->directed = graph->directed;
+    header->node_count = graph->node_count;
+    header->iface_count = iface_count;
+    header->edge_count = edge_count;
+    header->node_offset = node_offset;
+    header->iface_offset = iface_offset;
+    header->edge_offset = edge_offset;
+    header->checksum = Crc32(buf + sizeof(GraphImageHeader), total - sizeof(GraphImageHeader));
+
+    *size = total;
+    return buf;
+}
+
+// rename 只修改目录项，目录本身落盘后重命名才能在崩溃后保留
+static bool GraphImageSyncDir(const char *path) {
+    char dir[PATH_MAX];
+    const char *slash = strrchr(path, '/');
+    if (slash == NULL) {
+        snprintf(dir, sizeof(dir), ".");
+    } else if (slash == path) {
+        snprintf(dir, sizeof(dir), "/");
+    } else if (snprintf(dir, sizeof(dir), "%.*s", (int)(slash - path), path) >= (int)sizeof(dir)) {
+        return false;
+    }
+
+    int fd = open(dir, O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+// 写入
+/* Write to path.tmp, flush, rename over path and flush the directory. Saves are serialized */
+bool GraphImageWrite(const void *buf, size_t size, const char *path) {
+    char tmp[PATH_MAX];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) return false;
+
+    pthread_mutex_lock(&g_image_write_lock);
+    bool ok = false;
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        const uint8_t *p = (const uint8_t*)buf;
+        size_t left = size;
+        while (left > 0) {
+            ssize_t n = write(fd, p, left);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            p += n;
+            left -= n;
+        }
+        ok = (left == 0) && fsync(fd) == 0;
+        ok = (close(fd) == 0) && ok;
+        ok = ok && rename(tmp, path) == 0;
+        if (!ok) {
+            unlink(tmp);
+        } else {
+            ok = GraphImageSyncDir(path);
+        }
+    }
+    pthread_mutex_unlock(&g_image_write_lock);
+    return ok;
+}
+
+bool GraphImageSave(Graph *graph, const char *path) {
+    size_t size;
+    void *buf = GraphImageEncode(graph, &size);
+    if (!buf) return false;
+
+    bool ok = GraphImageWrite(buf, size, path);
+    FREE_S(buf);
+    return ok;
+}
+
+static void* GraphImageWorker(void *arg) {
+    GraphImageJob *job = (GraphImageJob*)arg;
+
+    GraphImageWrite(job->buf, job->size, job->path);
+    FREE_S(job->buf);
+    FREE_S(job);
+    return NULL;
+}
+
+/* Encode on the calling thread, then write and fsync on a detached thread */
+bool GraphImageSaveAsync(Graph *graph, const char *path) {
+    if (!path) return false;
+
+    size_t len = strlen(path) + 1;
+    GraphImageJob *job = (GraphImageJob*)MALLOC_S(sizeof(GraphImageJob) + len);
+    if (!job) return false;
+
+    memcpy(job->path, path, len);
+    job->buf = GraphImageEncode(graph, &job->size);
+    if (!job->buf) {
+        FREE_S(job);
+        return false;
+    }
+
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    bool ok = pthread_create(&thread, &attr, GraphImageWorker, job) == 0;
+    pthread_attr_destroy(&attr);
+
+    if (!ok) {
+        FREE_S(job->buf);
+        FREE_S(job);
+    }
+    return ok;
+}
+
+// 读取
+static bool GraphImageTableValid(uint64_t offset, uint64_t count, size_t elem, size_t size) {
+    return offset % GRAPH_IMAGE_ALIGN == 0 && offset <= size && count <= (size - offset) / elem;
+}
+
+static bool GraphImageValid(const void *map, size_t size) {
+    if (size < sizeof(GraphImageHeader)) return false;
+
+    const GraphImageHeader *header = (const GraphImageHeader*)map;
+    if (header->magic != GRAPH_IMAGE_MAGIC || header->format != GRAPH_IMAGE_FORMAT ||
+        header->endian != GRAPH_IMAGE_ENDIAN || header->size != size) {
+        return false;
+    }
+    if (!GraphImageTableValid(header->node_offset, header->node_count, sizeof(GraphImageNode), size) ||
+        !GraphImageTableValid(header->iface_offset, header->iface_count, sizeof(GraphImageIface), size) ||
+        !GraphImageTableValid(header->edge_offset, header->edge_count, sizeof(GraphImageEdge), size) ||
+        header->node_count > INT_MAX) {
+        return false;
+    }
+    return header->checksum == Crc32((const uint8_t*)map + sizeof(GraphImageHeader),
+                                     size - sizeof(GraphImageHeader));
+}
+
+/* Map and validate an image, NULL if missing, truncated or corrupt */
+GraphImage* GraphImageOpen(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(GraphImageHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    GraphImage *image = NULL;
+    if (GraphImageValid(map, size)) {
+        image = (GraphImage*)MALLOC_S(sizeof(GraphImage));
+    }
+    if (!image) {
+        munmap(map, size);
+        return NULL;
+    }
+
+    image->map = map;
+    image->size = size;
+    image->header = (const GraphImageHeader*)map;
+    image->nodes = (const GraphImageNode*)((const uint8_t*)map + image->header->node_offset);
+    image->ifaces = (const GraphImageIface*)((const uint8_t*)map + image->header->iface_offset);
+    image->edges = (const GraphImageEdge*)((const uint8_t*)map + image->header->edge_offset);
+    return image;
+}
+
+void GraphImageClose(GraphImage *image) {
+    if (!image) return;
+
+    munmap(image->map, image->size);
+    FREE_S(image);
+}
+
+static bool GraphImageLoadDevice(const GraphImage *image, const GraphImageNode *in, Device *device) {
+    memset(device, 0, sizeof(Device));
+    device->platform = (Platform)in->platform;
+    device->subplatform = (SubPlatType)in->subplatform;
+    device->hostname = ImageInternString(in->hostname, sizeof(in->hostname));
+    device->os_version = ImageInternString(in->os_version, sizeof(in->os_version));
+    device->architecture = ImageInternString(in->architecture, sizeof(in->architecture));
+    device->memory = in->memory;
+    device->storage = in->storage;
+    device->public_ip = in->public_ip;
+    device->private_ip = in->private_ip;
+
+    if (in->iface_count == 0) return true;
+
+    device->ifaces = (NetworkInterface*)CALLOC_S(in->iface_count, sizeof(NetworkInterface));
+    if (!device->ifaces) return false;
+
+    for (uint32_t k = 0; k < in->iface_count; k++) {
+        const GraphImageIface *src = &image->ifaces[in->iface_first + k];
+        NetworkInterface *iface = &device->ifaces[k];
+        iface->name = ImageInternString(src->name, sizeof(src->name));
+        iface->ip = src->ip;
+        memcpy(iface->mac, src->mac, sizeof(iface->mac) - 1);
+        iface->mtu = src->mtu;
+    }
+    device->iface_count = in->iface_count;
+    if (in->iface_used >= 0) {
+        device->iface = &device->ifaces[in->iface_used];
+    }
+    return true;
+}
+
+// 节点表中的下标范围在使用前逐一检查
+static bool GraphImageLoadNodes(Graph *graph, const GraphImage *image) {
+    const GraphImageHeader *header = image->header;
+
+    for (uint32_t i = 0; i < header->node_count; i++) {
+        const GraphImageNode *in = &image->nodes[i];
+        if ((uint64_t)in->iface_first + in->iface_count > header->iface_count ||
+            in->iface_used >= (int32_t)in->iface_count ||
+            (uint64_t)in->edge_first + in->edge_count > header->edge_count) {
+            return false;
+        }
+
+        Device device;
+        if (!GraphImageLoadDevice(image, in, &device)) return false;
+
+        GraphNode *node = GraphAddNodeWithId(graph, in->id, device);
+        if (!node) {
+            NodeRelease(&device);
+            return false;
+        }
+        node->flags = (in->flags & ~NODE_FLAG_LOCAL) | NODE_FLAG_STALE;
+    }
+    return true;
+}
+
+static bool GraphImageLoadEdges(Graph *graph, const GraphImage *image) {
+    const GraphImageHeader *header = image->header;
+
+    for (uint32_t i = 0; i < header->node_count; i++) {
+        const GraphImageNode *in = &image->nodes[i];
+        GraphReserveEdges(graph, in->id, in->edge_count);
+
+        for (uint32_t k = 0; k < in->edge_count; k++) {
+            const GraphImageEdge *edge = &image->edges[in->edge_first + k];
+            if (edge->to >= header->node_count) return false;
+
+            EdgeData data;
+            memset(&data, 0, sizeof(EdgeData));
+            data.utilize = edge->utilize;
+            data.bandwidth = edge->bandwidth;
+            data.latency = edge->latency;
+            data.packet_loss = edge->packet_loss;
+            data.port = edge->port;
+            data.traffic = edge->traffic;
+            data.last_communication = (time_t)edge->last_communication;
+            if (!GraphAddEdge(graph, in->id, image->nodes[edge->to].id, data)) return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Build a graph from an image. Nodes are marked NODE_FLAG_STALE until
+ * GraphUpdateNode confirms them, see GraphRemoveStale. The graph resumes at
+ * the saved version.
+ */
+Graph* GraphImageRestore(const GraphImage *image) {
+    if (!image) return NULL;
+
+    Graph *graph = GraphCreate(image->header->directed != 0);
+    if (!graph) return NULL;
+
+    if (!GraphReserve(graph, (int)image->header->node_count) ||
+        !GraphImageLoadNodes(graph, image) || !GraphImageLoadEdges(graph, image)) {
+        GraphDestroy(graph);
+        return NULL;
+    }
+
+    graph->version = image->header->version;
+    return graph;
+}
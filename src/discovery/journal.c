@@ -0,0 +1,160 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file journal.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/journal.h"
+
+#define GRAPH_JOURNAL_MIN_CAPACITY 64
+
+GraphJournal* GraphJournalCreate(int capacity) {
+    GraphJournal *journal = (GraphJournal*)CALLOC_S(1, sizeof(GraphJournal));
+    if (!journal) return NULL;
+
+    // 容量取 2 的幂，序号与掩码直接定位槽位
+    unsigned long size = GRAPH_JOURNAL_MIN_CAPACITY;
+    while (size < (unsigned long)MAX(capacity, 0)) {
+        size <<= 1;
+    }
+
+    journal->entries = (GraphDelta*)CALLOC_S(size, sizeof(GraphDelta));
+    if (!journal->entries) {
+        FREE_S(journal);
+        return NULL;
+    }
+    journal->mask = size - 1;
+    return journal;
+}
+
+void GraphJournalDestroy(GraphJournal *journal) {
+    if (!journal) return;
+
+    FREE_S(journal->entries);
+    FREE_S(journal);
+}
+
+/*
+ * Single writer. Readers copy entries without a lock and detect overwrites
+ * by re-reading `reserved` afterwards, the same way a seqlock works.
+ */
+void GraphJournalAppend(GraphJournal *journal, unsigned long version, GraphDeltaType type,
+                        int from_id, int to_id, const EdgeData *edge) {
+    if (!journal) return;
+
+    unsigned long seq = journal->head;
+    GraphDelta *delta = &journal->entries[seq & journal->mask];
+
+    // 先声明要覆盖的槽位，再写入内容
+    __atomic_store_n(&journal->reserved, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    if (seq > journal->mask) {
+        __atomic_store_n(&journal->lost_version, delta->version, __ATOMIC_RELAXED);
+    }
+
+    __atomic_store_n(&delta->version, version, __ATOMIC_RELAXED);
+    delta->type = type;
+    delta->from_id = from_id;
+    delta->to_id = to_id;
+    if (edge) {
+        delta->edge = *edge;
+        delta->edge.data = NULL;    // 附加数据归图所有，不随日志传递
+    } else {
+        memset(&delta->edge, 0, sizeof(EdgeData));
+    }
+
+    __atomic_store_n(&journal->head, seq + 1, __ATOMIC_RELEASE);
+}
+
+// 序号 seq 之前写入的记录是否仍未被覆盖
+static bool GraphJournalValid(const GraphJournal *journal, unsigned long seq) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    unsigned long reserved = __atomic_load_n(&journal->reserved, __ATOMIC_RELAXED);
+    return reserved <= journal->mask + 1 || seq >= reserved - (journal->mask + 1);
+}
+
+/*
+ * Sequence of the first delta newer than since_version, or GRAPH_JOURNAL_GAP
+ * when some of those deltas have already been overwritten.
+ * O(log capacity).
+ */
+unsigned long GraphJournalSeek(const GraphJournal *journal, unsigned long since_version) {
+    if (!journal) return GRAPH_JOURNAL_GAP;
+
+    unsigned long capacity = journal->mask + 1;
+    while (true) {
+        unsigned long head = __atomic_load_n(&journal->head, __ATOMIC_ACQUIRE);
+        unsigned long tail = head > capacity ? head - capacity : 0;
+
+        // 版本号单调不减，二分查找第一条更新的记录
+        unsigned long lo = tail, hi = head;
+        while (lo < hi) {
+            unsigned long mid = lo + (hi - lo) / 2;
+            if (__atomic_load_n(&journal->entries[mid & journal->mask].version, __ATOMIC_RELAXED) > since_version) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+
+        // 查找期间写者绕回覆盖了探测过的槽位则重试
+        if (!GraphJournalValid(journal, tail)) continue;
+
+        if (since_version < __atomic_load_n(&journal->lost_version, __ATOMIC_RELAXED)) {
+            return GRAPH_JOURNAL_GAP;
+        }
+        return lo;
+    }
+}
+
+/*
+ * Copy up to max deltas starting at *seq and advance the cursor.
+ * Returns the number copied, 0 when caught up, or -1 when the cursor has
+ * been overwritten and the caller must resync from a snapshot.
+ */
+int GraphJournalRead(const GraphJournal *journal, unsigned long *seq, GraphDelta *out, int max) {
+    if (!journal || !seq || *seq == GRAPH_JOURNAL_GAP || max < 0) return -1;
+
+    unsigned long head = __atomic_load_n(&journal->head, __ATOMIC_ACQUIRE);
+    if (*seq > head) return -1;
+
+    int count = (int)MIN(head - *seq, (unsigned long)max);
+    for (int i = 0; i < count; i++) {
+        out[i] = journal->entries[(*seq + i) & journal->mask];
+    }
+
+    if (!GraphJournalValid(journal, *seq)) return -1;
+
+    *seq += count;
+    return count;
+}
+
+const char* GraphDeltaTypeToString(GraphDeltaType type) {
+    switch (type) {
+        case GRAPH_DELTA_NODE_ADD: return "NodeAdd";
+        case GRAPH_DELTA_NODE_UPDATE: return "NodeUpdate";
+        case GRAPH_DELTA_NODE_REMOVE: return "NodeRemove";
+        case GRAPH_DELTA_EDGE_ADD: return "EdgeAdd";
+        case GRAPH_DELTA_EDGE_UPDATE: return "EdgeUpdate";
+        case GRAPH_DELTA_EDGE_REMOVE: return "EdgeRemove";
+        default: return "Unknown";
+    }
+}
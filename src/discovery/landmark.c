@@ -0,0 +1,137 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file landmark.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/landmark.h"
+
+// 单个方向的完整最短路径树，写入 row
+static bool landmark_tree(const GraphSnapshot *snap, int slot, MemArena *scratch, float *row, int *previous) {
+    MemArenaMark mark = mem_arena_mark(scratch);
+    bool ok = snapshot_dijkstra(snap, slot, GRAPH_INVALID_SLOT, scratch, row, previous);
+    mem_arena_release(scratch, mark);
+    return ok;
+}
+
+static LandmarkTable* landmark_table_alloc(const GraphSnapshot *snap, int count) {
+    LandmarkTable *table = (LandmarkTable*)CALLOC_S(1, sizeof(LandmarkTable));
+    if (!table) return NULL;
+
+    size_t cells = (size_t)MAX(count, 1) * MAX(snap->slot_count, 1);
+    table->landmarks = (int*)MALLOC_S(MAX(count, 1) * sizeof(int));
+    table->from = (float*)MALLOC_S(cells * sizeof(float));
+    if (snap->directed) {
+        table->to = (float*)MALLOC_S(cells * sizeof(float));
+        table->reverse = GraphSnapshotReverse(snap);
+    } else {
+        table->to = table->from;
+    }
+    if (!table->landmarks || !table->from || !table->to || (snap->directed && !table->reverse)) {
+        landmark_table_destroy(table);
+        return NULL;
+    }
+
+    table->version = snap->version;
+    table->slot_count = snap->slot_count;
+    return table;
+}
+
+// 最远点选取：每次取离已选地标最远的槽位，不可达的槽位最优先，使每个连通分量都有地标
+LandmarkTable* landmark_table_build(const GraphSnapshot *snap, int count) {
+    if (!snap) return NULL;
+
+    int live = 0;
+    for (int i = 0; i < snap->slot_count; i++) {
+        if (snap->ids[i] != GRAPH_INVALID_ID) live++;
+    }
+    count = MIN(MIN(MAX(count, 1), LANDMARK_MAX_COUNT), live);
+
+    LandmarkTable *table = landmark_table_alloc(snap, count);
+    if (!table || count == 0) return table;
+
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    float *nearest = ARENA_ALLOC_S(scratch, snap->slot_count, float);
+    int *previous = ARENA_ALLOC_S(scratch, snap->slot_count, int);
+    if (!nearest || !previous) {
+        mem_arena_release(scratch, mark);
+        landmark_table_destroy(table);
+        return NULL;
+    }
+
+    // 首个地标取离第一个有效槽位最远的节点
+    int seed = 0;
+    while (snap->ids[seed] == GRAPH_INVALID_ID) seed++;
+    if (!landmark_tree(snap, seed, scratch, table->from, previous)) {
+        mem_arena_release(scratch, mark);
+        landmark_table_destroy(table);
+        return NULL;
+    }
+    int first = seed;
+    for (int i = 0; i < snap->slot_count; i++) {
+        nearest[i] = snap->ids[i] == GRAPH_INVALID_ID ? -1 : FLT_MAX;
+        if (nearest[i] >= 0 && table->from[i] != FLT_MAX && table->from[i] > table->from[first]) {
+            first = i;
+        }
+    }
+
+    for (int n = 0; n < count; n++) {
+        int landmark = first;
+        if (n > 0) {
+            landmark = -1;
+            for (int i = 0; i < snap->slot_count; i++) {
+                if (nearest[i] < 0) continue;
+                if (landmark < 0 || nearest[i] > nearest[landmark]) landmark = i;
+            }
+        }
+
+        float *from = table->from + (size_t)n * snap->slot_count;
+        float *to = table->to + (size_t)n * snap->slot_count;
+        if (!landmark_tree(snap, landmark, scratch, from, previous) ||
+            (table->reverse && !landmark_tree(table->reverse, landmark, scratch, to, previous))) {
+            mem_arena_release(scratch, mark);
+            landmark_table_destroy(table);
+            return NULL;
+        }
+
+        table->landmarks[n] = landmark;
+        table->count = n + 1;
+        nearest[landmark] = -1;
+        for (int i = 0; i < snap->slot_count; i++) {
+            if (nearest[i] < 0) continue;
+            nearest[i] = MIN(nearest[i], from[i]);
+        }
+    }
+
+    mem_arena_release(scratch, mark);
+    return table;
+}
+
+void landmark_table_destroy(LandmarkTable *table) {
+    if (!table) return;
+
+    if (table->to && table->to != table->from) FREE_S(table->to);
+    if (table->from) FREE_S(table->from);
+    if (table->landmarks) FREE_S(table->landmarks);
+    GraphSnapshotDestroy(table->reverse);
+    FREE_S(table);
+}
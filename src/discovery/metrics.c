@@ -0,0 +1,305 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file metrics.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/metrics.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EDGE_METRICS_X86 1
+#endif
+
+#define EDGE_METRICS_ALIGN 32
+
+EdgeMetrics* EdgeMetricsCreate(float alpha) {
+    EdgeMetrics *metrics = (EdgeMetrics*)CALLOC_S(1, sizeof(EdgeMetrics));
+    if (!metrics) return NULL;
+
+    metrics->alpha = alpha;
+    return metrics;
+}
+
+void EdgeMetricsDestroy(EdgeMetrics *metrics) {
+    if (!metrics) return;
+
+    free(metrics->free_lanes);
+    free(metrics->latency_ring);
+    free(metrics->loss_ring);
+    free(metrics->bandwidth_ring);
+    free(metrics->ring_head);
+    free(metrics->ring_fill);
+    free(metrics->latency_sum);
+    free(metrics->loss_sum);
+    free(metrics->bandwidth_sum);
+    free(metrics->pending);
+    free(metrics->latency);
+    free(metrics->loss);
+    free(metrics->bandwidth);
+    free(metrics->primed);
+    free(metrics);
+}
+
+// 数组按 32 字节对齐分配，新增部分清零
+static bool MetricsGrowArray(void **array, size_t elem, int old_count, int new_count) {
+    void *grown = MALLOC_ALIGNED_S(EDGE_METRICS_ALIGN, new_count * elem);
+    if (!grown) return false;
+
+    if (*array) {
+        memcpy(grown, *array, old_count * elem);
+        free(*array);
+    }
+    memset((char*)grown + old_count * elem, 0, (new_count - old_count) * elem);
+    *array = grown;
+    return true;
+}
+
+static bool EdgeMetricsGrow(EdgeMetrics *metrics) {
+    int old = metrics->capacity;
+    int cap = old ? old * 2 : 64;
+    const int S = EDGE_METRIC_SAMPLES;
+
+    // 任一数组失败时已扩容的数组保持有效，容量仍按旧值计
+    if (!MetricsGrowArray((void**)&metrics->latency_ring, S * sizeof(float), old, cap) ||
+        !MetricsGrowArray((void**)&metrics->loss_ring, S * sizeof(float), old, cap) ||
+        !MetricsGrowArray((void**)&metrics->bandwidth_ring, S * sizeof(float), old, cap) ||
+        !MetricsGrowArray((void**)&metrics->ring_head, sizeof(uint8_t), old, cap) ||
+        !MetricsGrowArray((void**)&metrics->ring_fill, sizeof(uint8_t), old, cap) ||
+        !MetricsGrowArray((void**)&metrics->latency_sum, sizeof(float), old, cap) ||
+        !MetricsGrowArray((void**)&metrics->loss_sum, sizeof(float), old, cap) ||
+        !MetricsGrowArray((void**)&metrics->bandwidth_sum, sizeof(float), old, cap) ||
+        !MetricsGrowArray((void**)&metrics->pending, sizeof(float), old, cap) ||
+        !MetricsGrowArray((void**)&metrics->latency, sizeof(float), old, cap) ||
+        !MetricsGrowArray((void**)&metrics->loss, sizeof(float), old, cap) ||
+        !MetricsGrowArray((void**)&metrics->bandwidth, sizeof(float), old, cap) ||
+        !MetricsGrowArray((void**)&metrics->primed, sizeof(float), old, cap)) {
+        return false;
+    }
+
+    int *free_lanes = (int*)RELLOC_S(metrics->free_lanes, cap * sizeof(int));
+    if (!free_lanes) return false;
+
+    metrics->free_lanes = free_lanes;
+    metrics->capacity = cap;
+    return true;
+}
+
+/* A cleared lane, EDGE_METRIC_NONE when out of memory */
+int EdgeMetricsAcquire(EdgeMetrics *metrics) {
+    int lane;
+    if (metrics->free_count > 0) {
+        lane = metrics->free_lanes[--metrics->free_count];
+    } else {
+        if (metrics->count >= metrics->capacity && !EdgeMetricsGrow(metrics)) return EDGE_METRIC_NONE;
+        lane = metrics->count++;
+    }
+
+    metrics->ring_head[lane] = 0;
+    metrics->ring_fill[lane] = 0;
+    metrics->latency_sum[lane] = metrics->loss_sum[lane] = metrics->bandwidth_sum[lane] = 0.0f;
+    metrics->pending[lane] = 0.0f;
+    metrics->latency[lane] = metrics->loss[lane] = metrics->bandwidth[lane] = 0.0f;
+    metrics->primed[lane] = 0.0f;
+    return lane;
+}
+
+void EdgeMetricsRelease(EdgeMetrics *metrics, int lane) {
+    if (!metrics || lane < 0) return;
+
+    // 空闲通道不参与聚合
+    metrics->pending[lane] = 0.0f;
+    metrics->primed[lane] = 0.0f;
+    metrics->free_lanes[metrics->free_count++] = lane;
+}
+
+void EdgeMetricsRecord(EdgeMetrics *metrics, int lane, float latency, float packet_loss, float bandwidth) {
+    int pos = lane * EDGE_METRIC_SAMPLES + metrics->ring_head[lane];
+    metrics->latency_ring[pos] = latency;
+    metrics->loss_ring[pos] = packet_loss;
+    metrics->bandwidth_ring[pos] = bandwidth;
+    metrics->ring_head[lane] = (metrics->ring_head[lane] + 1) % EDGE_METRIC_SAMPLES;
+    if (metrics->ring_fill[lane] < EDGE_METRIC_SAMPLES) {
+        metrics->ring_fill[lane]++;
+    }
+
+    metrics->latency_sum[lane] += latency;
+    metrics->loss_sum[lane] += packet_loss;
+    metrics->bandwidth_sum[lane] += bandwidth;
+    metrics->pending[lane] += 1.0f;
+}
+
+// 聚合：有新样本的通道以本轮均值更新 EWMA，首次聚合直接取均值
+// a = pending ? (primed ? alpha : 1) : 0，用掩码代替分支以便向量化
+static int EdgeMetricsAggregateScalar(EdgeMetrics *m, int begin, int end) {
+    int updated = 0;
+    for (int i = begin; i < end; i++) {
+        float n = m->pending[i];
+        if (n == 0.0f) continue;
+
+        float a = m->primed[i] != 0.0f ? m->alpha : 1.0f;
+        m->latency[i] += a * (m->latency_sum[i] / n - m->latency[i]);
+        m->loss[i] += a * (m->loss_sum[i] / n - m->loss[i]);
+        m->bandwidth[i] += a * (m->bandwidth_sum[i] / n - m->bandwidth[i]);
+        m->latency_sum[i] = m->loss_sum[i] = m->bandwidth_sum[i] = 0.0f;
+        m->pending[i] = 0.0f;
+        m->primed[i] = 1.0f;
+        updated++;
+    }
+    return updated;
+}
+
+#ifdef EDGE_METRICS_X86
+__attribute__((target("sse2")))
+static int EdgeMetricsAggregateSSE(EdgeMetrics *m, int end) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 keep = _mm_set1_ps(1.0f - m->alpha);
+    int updated = 0;
+
+    for (int i = 0; i < end; i += 4) {
+        __m128 n = _mm_loadu_ps(&m->pending[i]);
+        __m128 mask = _mm_cmpgt_ps(n, zero);
+        int bits = _mm_movemask_ps(mask);
+        if (!bits) continue;
+
+        __m128 primed = _mm_loadu_ps(&m->primed[i]);
+        __m128 a = _mm_and_ps(mask, _mm_sub_ps(one, _mm_mul_ps(primed, keep)));
+        __m128 div = _mm_max_ps(n, one);
+
+#define EDGE_METRICS_SSE_FOLD(sum, value) do { \
+            __m128 v = _mm_loadu_ps(&m->value[i]); \
+            __m128 mean = _mm_div_ps(_mm_loadu_ps(&m->sum[i]), div); \
+            _mm_storeu_ps(&m->value[i], _mm_add_ps(v, _mm_mul_ps(a, _mm_sub_ps(mean, v)))); \
+            _mm_storeu_ps(&m->sum[i], zero); \
+        } while (0)
+
+        EDGE_METRICS_SSE_FOLD(latency_sum, latency);
+        EDGE_METRICS_SSE_FOLD(loss_sum, loss);
+        EDGE_METRICS_SSE_FOLD(bandwidth_sum, bandwidth);
+#undef EDGE_METRICS_SSE_FOLD
+
+        _mm_storeu_ps(&m->pending[i], zero);
+        _mm_storeu_ps(&m->primed[i], _mm_or_ps(primed, _mm_and_ps(mask, one)));
+        updated += __builtin_popcount(bits);
+    }
+    return updated;
+}
+
+__attribute__((target("avx")))
+static int EdgeMetricsAggregateAVX(EdgeMetrics *m, int end) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 keep = _mm256_set1_ps(1.0f - m->alpha);
+    int updated = 0;
+
+    for (int i = 0; i < end; i += 8) {
+        __m256 n = _mm256_loadu_ps(&m->pending[i]);
+        __m256 mask = _mm256_cmp_ps(n, zero, _CMP_GT_OQ);
+        int bits = _mm256_movemask_ps(mask);
+        if (!bits) continue;
+
+        __m256 primed = _mm256_loadu_ps(&m->primed[i]);
+        __m256 a = _mm256_and_ps(mask, _mm256_sub_ps(one, _mm256_mul_ps(primed, keep)));
+        __m256 div = _mm256_max_ps(n, one);
+
+#define EDGE_METRICS_AVX_FOLD(sum, value) do { \
+            __m256 v = _mm256_loadu_ps(&m->value[i]); \
+            __m256 mean = _mm256_div_ps(_mm256_loadu_ps(&m->sum[i]), div); \
+            _mm256_storeu_ps(&m->value[i], _mm256_add_ps(v, _mm256_mul_ps(a, _mm256_sub_ps(mean, v)))); \
+            _mm256_storeu_ps(&m->sum[i], zero); \
+        } while (0)
+
+        EDGE_METRICS_AVX_FOLD(latency_sum, latency);
+        EDGE_METRICS_AVX_FOLD(loss_sum, loss);
+        EDGE_METRICS_AVX_FOLD(bandwidth_sum, bandwidth);
+#undef EDGE_METRICS_AVX_FOLD
+
+        _mm256_storeu_ps(&m->pending[i], zero);
+        _mm256_storeu_ps(&m->primed[i], _mm256_or_ps(primed, _mm256_and_ps(mask, one)));
+        updated += __builtin_popcount(bits);
+    }
+    return updated;
+}
+#endif
+
+/*
+ * Fold pending samples of every lane into the smoothed values.
+ * Returns the number of lanes that changed. Uses AVX or SSE2 when the CPU
+ * has them, the scalar loop otherwise.
+ */
+int EdgeMetricsAggregate(EdgeMetrics *metrics) {
+    if (!metrics || metrics->count == 0) return 0;
+
+    // 容量按 64 的倍数增长，向量循环可以覆盖到整组末尾
+    int end = (metrics->count + EDGE_METRIC_LANES - 1) & ~(EDGE_METRIC_LANES - 1);
+#ifdef EDGE_METRICS_X86
+    static int avx = -1;
+    if (avx < 0) {
+        __builtin_cpu_init();
+        avx = __builtin_cpu_supports("avx") ? 1 : 0;
+    }
+    if (avx) return EdgeMetricsAggregateAVX(metrics, end);
+    if (__builtin_cpu_supports("sse2")) return EdgeMetricsAggregateSSE(metrics, end);
+#endif
+    return EdgeMetricsAggregateScalar(metrics, 0, end);
+}
+
+// 分位数取排序后最接近的样本，样本最多 EDGE_METRIC_SAMPLES 个，插入排序即可
+static void MetricsSort(float *values, int count) {
+    for (int i = 1; i < count; i++) {
+        float v = values[i];
+        int j = i - 1;
+        while (j >= 0 && values[j] > v) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = v;
+    }
+}
+
+static float MetricsRank(const float *sorted, int count, float q) {
+    int rank = (int)(q * (count - 1) + 0.5f);
+    return sorted[MIN(rank, count - 1)];
+}
+
+void EdgeMetricsStats(const EdgeMetrics *metrics, int lane, EdgeStats *stats) {
+    memset(stats, 0, sizeof(EdgeStats));
+    if (!metrics || lane < 0) return;
+
+    int count = metrics->ring_fill[lane];
+    stats->latency = metrics->latency[lane];
+    stats->packet_loss = metrics->loss[lane];
+    stats->bandwidth = metrics->bandwidth[lane];
+    stats->samples = count;
+    if (count == 0) return;
+
+    float latency[EDGE_METRIC_SAMPLES], loss[EDGE_METRIC_SAMPLES];
+    memcpy(latency, &metrics->latency_ring[lane * EDGE_METRIC_SAMPLES], count * sizeof(float));
+    memcpy(loss, &metrics->loss_ring[lane * EDGE_METRIC_SAMPLES], count * sizeof(float));
+    MetricsSort(latency, count);
+    MetricsSort(loss, count);
+
+    stats->latency_p50 = MetricsRank(latency, count, 0.50f);
+    stats->latency_p99 = MetricsRank(latency, count, 0.99f);
+    stats->loss_p50 = MetricsRank(loss, count, 0.50f);
+    stats->loss_p99 = MetricsRank(loss, count, 0.99f);
+}
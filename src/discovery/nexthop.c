@@ -0,0 +1,193 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file nexthop.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/nexthop.h"
+
+#define NEXT_HOP_UNKNOWN -2
+
+typedef struct NextHopShared_ {
+    const GraphSnapshot *snap;
+    NextHopTable *table;
+    int next_source;            /* Claimed with fetch-add */
+    bool failed;
+} NextHopShared;
+
+static void next_hop_store(NextHopTable *table, size_t i, int hop) {
+    if (table->wide) {
+        table->hops32[i] = hop < 0 ? NEXT_HOP_NONE32 : (uint32_t)hop;
+    } else {
+        table->hops16[i] = hop < 0 ? NEXT_HOP_NONE16 : (uint16_t)hop;
+    }
+}
+
+// 由前驱树求每个目的节点的第一跳：沿前驱回溯到已知节点，再回填整条链，总计 O(V)
+static void next_hop_fill_row(NextHopTable *table, int src, const int *previous, int *first, int *stack) {
+    int n = table->slot_count;
+    for (int v = 0; v < n; v++) {
+        first[v] = NEXT_HOP_UNKNOWN;
+    }
+    first[src] = src;
+
+    for (int v = 0; v < n; v++) {
+        int u = v;
+        int top = 0;
+        while (first[u] == NEXT_HOP_UNKNOWN) {
+            if (previous[u] < 0) {
+                first[u] = GRAPH_INVALID_SLOT;
+                break;
+            }
+            if (previous[u] == src) {
+                first[u] = u;
+                break;
+            }
+            stack[top++] = u;
+            u = previous[u];
+        }
+        while (top > 0) {
+            first[stack[--top]] = first[u];
+        }
+    }
+
+    size_t row = (size_t)src * n;
+    for (int v = 0; v < n; v++) {
+        next_hop_store(table, row + v, first[v]);
+    }
+}
+
+static void* next_hop_worker(void *arg) {
+    NextHopShared *shared = (NextHopShared*)arg;
+    const GraphSnapshot *snap = shared->snap;
+    int n = snap->slot_count;
+
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    float *distances = ARENA_ALLOC_S(scratch, n, float);
+    int *previous = ARENA_ALLOC_S(scratch, n, int);
+    int *first = ARENA_ALLOC_S(scratch, n, int);
+    int *stack = ARENA_ALLOC_S(scratch, n, int);
+    if (!distances || !previous || !first || !stack) {
+        __atomic_store_n(&shared->failed, true, __ATOMIC_RELAXED);
+        mem_arena_release(scratch, mark);
+        return NULL;
+    }
+
+    while (!__atomic_load_n(&shared->failed, __ATOMIC_RELAXED)) {
+        int src = __atomic_fetch_add(&shared->next_source, 1, __ATOMIC_RELAXED);
+        if (src >= n) break;
+
+        if (snap->ids[src] == GRAPH_INVALID_ID) {
+            for (int v = 0; v < n; v++) {
+                next_hop_store(shared->table, (size_t)src * n + v, GRAPH_INVALID_SLOT);
+            }
+            continue;
+        }
+
+        // 堆按源节点分配，每轮结束回退
+        MemArenaMark round = mem_arena_mark(scratch);
+        if (!snapshot_dijkstra(snap, src, GRAPH_INVALID_SLOT, scratch, distances, previous)) {
+            __atomic_store_n(&shared->failed, true, __ATOMIC_RELAXED);
+            mem_arena_release(scratch, round);
+            break;
+        }
+        next_hop_fill_row(shared->table, src, previous, first, stack);
+        mem_arena_release(scratch, round);
+    }
+
+    mem_arena_release(scratch, mark);
+    return NULL;
+}
+
+static void* next_hop_thread_main(void *arg) {
+    next_hop_worker(arg);
+    mem_thread_arena_destroy();
+    return NULL;
+}
+
+static NextHopTable* next_hop_table_alloc(const GraphSnapshot *snap) {
+    NextHopTable *table = (NextHopTable*)CALLOC_S(1, sizeof(NextHopTable));
+    if (!table) return NULL;
+
+    int n = snap->slot_count;
+    size_t cells = (size_t)MAX(n, 1) * MAX(n, 1);
+    table->version = snap->version;
+    table->slot_count = n;
+    table->wide = n > NEXT_HOP_MAX_SLOTS;
+    if (table->wide) {
+        table->hops32 = (uint32_t*)MALLOC_S(cells * sizeof(uint32_t));
+    } else {
+        table->hops16 = (uint16_t*)MALLOC_S(cells * sizeof(uint16_t));
+    }
+    table->ids = (int*)MALLOC_S(MAX(n, 1) * sizeof(int));
+    table->index.entries = (GraphIndexEntry*)MALLOC_S((snap->index.mask + 1) * sizeof(GraphIndexEntry));
+    if (!table->hops16 || !table->ids || !table->index.entries) {
+        next_hop_table_destroy(table);
+        return NULL;
+    }
+
+    memcpy(table->ids, snap->ids, n * sizeof(int));
+    memcpy(table->index.entries, snap->index.entries, (snap->index.mask + 1) * sizeof(GraphIndexEntry));
+    table->index.mask = snap->index.mask;
+    table->index.count = snap->index.count;
+    return table;
+}
+
+/*
+ * Build the table for snap with up to threads workers, the caller being one
+ * of them. Memory is slot_count^2 entries, meant for LAN-sized graphs.
+ */
+NextHopTable* next_hop_table_build(const GraphSnapshot *snap, int threads) {
+    if (!snap) return NULL;
+
+    NextHopTable *table = next_hop_table_alloc(snap);
+    if (!table || snap->slot_count == 0) return table;
+
+    NextHopShared shared = { snap, table, 0, false };
+    threads = MAX(1, MIN(threads, MIN(SNAPSHOT_MAX_THREADS, snap->slot_count)));
+    pthread_t tids[SNAPSHOT_MAX_THREADS];
+    int created = 0;
+    while (created < threads - 1) {
+        if (pthread_create(&tids[created], NULL, next_hop_thread_main, &shared) != 0) break;
+        created++;
+    }
+
+    next_hop_worker(&shared);
+    for (int i = 0; i < created; i++) {
+        pthread_join(tids[i], NULL);
+    }
+
+    if (shared.failed) {
+        next_hop_table_destroy(table);
+        return NULL;
+    }
+    return table;
+}
+
+void next_hop_table_destroy(NextHopTable *table) {
+    if (!table) return;
+
+    free(table->hops16);
+    free(table->ids);
+    free(table->index.entries);
+    FREE_S(table);
+}
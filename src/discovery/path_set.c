@@ -0,0 +1,103 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file path_set.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/path_set.h"
+
+PathSet* path_set_create(int paths, int ids) {
+    PathSet *set = (PathSet*)CALLOC_S(1, sizeof(PathSet));
+    if (!set) return NULL;
+
+    if (!path_set_reserve(set, MAX(paths, PATH_SET_MIN_PATHS), MAX(ids, PATH_SET_MIN_IDS))) {
+        path_set_destroy(set);
+        return NULL;
+    }
+    return set;
+}
+
+void path_set_destroy(PathSet *set) {
+    if (!set) return;
+
+    if (set->node_ids) FREE_S(set->node_ids);
+    if (set->offsets) FREE_S(set->offsets);
+    if (set->costs) FREE_S(set->costs);
+    FREE_S(set);
+}
+
+void path_set_reset(PathSet *set) {
+    set->count = 0;
+    set->offsets[0] = 0;
+}
+
+// 保证还能再放 paths 条路径、ids 个节点，容量按倍数增长
+bool path_set_reserve(PathSet *set, int paths, int ids) {
+    int used = set->offsets ? set->offsets[set->count] : 0;
+
+    if (set->count + paths > set->path_capacity) {
+        int capacity = MAX(set->path_capacity * 2, set->count + paths);
+        int *offsets = (int*)RELLOC_S(set->offsets, (capacity + 1) * sizeof(int));
+        if (!offsets) return false;
+        if (!set->offsets) offsets[0] = 0;
+        set->offsets = offsets;
+
+        float *costs = (float*)RELLOC_S(set->costs, capacity * sizeof(float));
+        if (!costs) return false;
+        set->costs = costs;
+        set->path_capacity = capacity;
+    }
+
+    if (used + ids > set->id_capacity) {
+        int capacity = MAX(set->id_capacity * 2, used + ids);
+        int *node_ids = (int*)RELLOC_S(set->node_ids, capacity * sizeof(int));
+        if (!node_ids) return false;
+        set->node_ids = node_ids;
+        set->id_capacity = capacity;
+    }
+    return true;
+}
+
+// 返回路径下标，失败返回 -1；length 为 0 时记录一条空路径占位
+int path_set_add(PathSet *set, const int *node_ids, int length, float total_cost) {
+    if (!path_set_reserve(set, 1, length)) return -1;
+
+    int offset = set->offsets[set->count];
+    if (length > 0) {
+        memcpy(set->node_ids + offset, node_ids, length * sizeof(int));
+    }
+    set->costs[set->count] = total_cost;
+    set->offsets[++set->count] = offset + length;
+    return set->count - 1;
+}
+
+void path_set_print(const PathSet *set, Graph *graph) {
+    PathSetIter iter;
+    Path path;
+    path_set_iter_init(&iter, set);
+    while (path_set_next(&iter, &path)) {
+        if (path.length > 0) {
+            path_print(&path, graph);
+        } else {
+            printf("No path\n");
+        }
+    }
+}
@@ -0,0 +1,269 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file route_cache.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/route_cache.h"
+
+#define ROUTE_CACHE_EMPTY -1
+
+static inline unsigned int route_cache_hash(int src_id, int dst_id) {
+    uint32_t h = (uint32_t)src_id * 0x9e3779b1U ^ (uint32_t)dst_id;
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+RouteCache* route_cache_create(int capacity) {
+    RouteCache *cache = (RouteCache*)CALLOC_S(1, sizeof(RouteCache));
+    if (!cache) return NULL;
+
+    capacity = MAX(capacity, ROUTE_CACHE_MIN_CAPACITY);
+    unsigned int index_capacity = 1;
+    while (index_capacity < (unsigned int)capacity * 2) {
+        index_capacity <<= 1;
+    }
+
+    cache->entries = (RouteCacheEntry*)CALLOC_S(capacity, sizeof(RouteCacheEntry));
+    cache->index = (int*)MALLOC_S(index_capacity * sizeof(int));
+    if (!cache->entries || !cache->index) {
+        route_cache_destroy(cache);
+        return NULL;
+    }
+
+    cache->capacity = capacity;
+    cache->index_mask = index_capacity - 1;
+    for (int i = 0; i < capacity; i++) {
+        cache->entries[i].dst = GRAPH_INVALID_ID;
+    }
+    for (unsigned int i = 0; i < index_capacity; i++) {
+        cache->index[i] = ROUTE_CACHE_EMPTY;
+    }
+    return cache;
+}
+
+void route_cache_clear(RouteCache *cache) {
+    if (!cache) return;
+
+    for (int i = 0; i < cache->capacity; i++) {
+        RouteCacheEntry *entry = &cache->entries[i];
+        if (entry->dst != GRAPH_INVALID_ID) {
+            path_destroy(entry->path);
+            entry->path = NULL;
+            entry->dst = GRAPH_INVALID_ID;
+        }
+    }
+    for (unsigned int i = 0; i <= cache->index_mask; i++) {
+        cache->index[i] = ROUTE_CACHE_EMPTY;
+    }
+    cache->count = 0;
+    cache->hand = 0;
+}
+
+void route_cache_destroy(RouteCache *cache) {
+    if (!cache) return;
+
+    if (cache->entries && cache->index) {
+        route_cache_clear(cache);
+    }
+    FREE_S(cache->entries);
+    FREE_S(cache->index);
+    FREE_S(cache);
+}
+
+// 索引：线性探测，删除时回移
+static int route_cache_find(const RouteCache *cache, int src_id, int dst_id) {
+    unsigned int i = route_cache_hash(src_id, dst_id) & cache->index_mask;
+    while (cache->index[i] != ROUTE_CACHE_EMPTY) {
+        const RouteCacheEntry *entry = &cache->entries[cache->index[i]];
+        if (entry->src == src_id && entry->dst == dst_id) {
+            return i;
+        }
+        i = (i + 1) & cache->index_mask;
+    }
+    return -1;
+}
+
+static void route_cache_index_put(RouteCache *cache, int slot) {
+    const RouteCacheEntry *entry = &cache->entries[slot];
+    unsigned int i = route_cache_hash(entry->src, entry->dst) & cache->index_mask;
+    while (cache->index[i] != ROUTE_CACHE_EMPTY) {
+        i = (i + 1) & cache->index_mask;
+    }
+    cache->index[i] = slot;
+}
+
+static void route_cache_index_erase(RouteCache *cache, unsigned int i) {
+    unsigned int j = i;
+    cache->index[i] = ROUTE_CACHE_EMPTY;
+    while (true) {
+        j = (j + 1) & cache->index_mask;
+        if (cache->index[j] == ROUTE_CACHE_EMPTY) break;
+
+        const RouteCacheEntry *entry = &cache->entries[cache->index[j]];
+        unsigned int k = route_cache_hash(entry->src, entry->dst) & cache->index_mask;
+        if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) continue;
+
+        cache->index[i] = cache->index[j];
+        cache->index[j] = ROUTE_CACHE_EMPTY;
+        i = j;
+    }
+}
+
+static void route_cache_drop(RouteCache *cache, unsigned int index_pos) {
+    RouteCacheEntry *entry = &cache->entries[cache->index[index_pos]];
+    route_cache_index_erase(cache, index_pos);
+    path_destroy(entry->path);
+    entry->path = NULL;
+    entry->dst = GRAPH_INVALID_ID;
+    cache->count--;
+}
+
+// CLOCK：跳过并清除最近被访问的条目，淘汰第一个未被访问的
+static int route_cache_victim(RouteCache *cache) {
+    while (true) {
+        int slot = cache->hand;
+        RouteCacheEntry *entry = &cache->entries[slot];
+        cache->hand = (cache->hand + 1) % cache->capacity;
+
+        if (entry->dst == GRAPH_INVALID_ID) return slot;
+        if (entry->referenced) {
+            entry->referenced = false;
+            continue;
+        }
+
+        route_cache_drop(cache, route_cache_find(cache, entry->src, entry->dst));
+        cache->stats.evictions++;
+        return slot;
+    }
+}
+
+static bool route_cache_on_path(const Path *path, int from_id, int to_id, bool directed) {
+    for (int i = 0; i + 1 < path->length; i++) {
+        int a = path->node_ids[i];
+        int b = path->node_ids[i + 1];
+        if ((a == from_id && b == to_id) || (!directed && a == to_id && b == from_id)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool route_cache_visits(const Path *path, int node_id) {
+    for (int i = 0; i < path->length; i++) {
+        if (path->node_ids[i] == node_id) return true;
+    }
+    return false;
+}
+
+// 变化能否改变该路由：删除只会让其他路径变长，节点增改不影响边权
+static bool route_cache_delta_harmless(const RouteCacheEntry *entry, const GraphDelta *delta, bool directed) {
+    switch (delta->type) {
+        case GRAPH_DELTA_NODE_ADD:
+        case GRAPH_DELTA_NODE_UPDATE:
+            return true;
+        case GRAPH_DELTA_NODE_REMOVE:
+            return !entry->path || !route_cache_visits(entry->path, delta->from_id);
+        case GRAPH_DELTA_EDGE_REMOVE:
+            return !entry->path || !route_cache_on_path(entry->path, delta->from_id, delta->to_id, directed);
+        default:
+            // 新增或更新的边可能带来更短的路径
+            return false;
+    }
+}
+
+// 重放 (entry->version, version] 之间的日志；没有日志的版本（例如度量聚合）视为失效
+static bool route_cache_revalidate(const RouteCacheEntry *entry, const GraphJournal *journal,
+                                   unsigned long version, bool directed) {
+    if (!journal || entry->version > version) return false;
+
+    unsigned long seq = GraphJournalSeek(journal, entry->version);
+    if (seq == GRAPH_JOURNAL_GAP) return false;
+
+    GraphDelta deltas[ROUTE_CACHE_MAX_REPLAY];
+    int count = GraphJournalRead(journal, &seq, deltas, ROUTE_CACHE_MAX_REPLAY);
+    if (count < 0) return false;
+
+    unsigned long seen = entry->version;
+    int i = 0;
+    for (; i < count && deltas[i].version <= version; i++) {
+        if (deltas[i].version != seen && deltas[i].version != seen + 1) return false;
+        if (!route_cache_delta_harmless(entry, &deltas[i], directed)) return false;
+        seen = deltas[i].version;
+    }
+    // 读满时同一批次可能还有未读的变化，只有读到更新的版本才能确认已覆盖完整
+    if (i == ROUTE_CACHE_MAX_REPLAY) return false;
+    return seen == version;
+}
+
+/*
+ * Route from src_id to dst_id on snap, NULL when unreachable. The path is
+ * owned by the cache and valid until the next call on the same cache.
+ * journal may be NULL, then only an exact version match hits.
+ */
+const Path* route_cache_get(RouteCache *cache, const GraphSnapshot *snap, const GraphJournal *journal,
+                            int src_id, int dst_id) {
+    if (!cache || !snap) return NULL;
+
+    int pos = route_cache_find(cache, src_id, dst_id);
+    if (pos >= 0) {
+        RouteCacheEntry *entry = &cache->entries[cache->index[pos]];
+        if (entry->version == snap->version ||
+            route_cache_revalidate(entry, journal, snap->version, snap->directed)) {
+            if (entry->version != snap->version) {
+                entry->version = snap->version;
+                cache->stats.revalidated++;
+            }
+            entry->referenced = true;
+            cache->stats.hits++;
+            return entry->path;
+        }
+
+        route_cache_drop(cache, pos);
+        cache->stats.invalidated++;
+    }
+
+    cache->stats.misses++;
+    int slot = route_cache_victim(cache);
+    RouteCacheEntry *entry = &cache->entries[slot];
+    entry->src = src_id;
+    entry->dst = dst_id;
+    entry->version = snap->version;
+    entry->path = snapshot_find_shortest_path(snap, src_id, dst_id);
+    entry->referenced = false;
+    route_cache_index_put(cache, slot);
+    cache->count++;
+    return entry->path;
+}
+
+void route_cache_print_stats(const RouteCache *cache) {
+    if (!cache) return;
+
+    const RouteCacheStats *stats = &cache->stats;
+    unsigned long lookups = stats->hits + stats->misses;
+    printf("Route cache: entries %d/%d, hits %lu (%.1f%%, revalidated %lu), misses %lu, invalidated %lu, evicted %lu\n",
+           cache->count, cache->capacity, stats->hits, lookups ? 100.0 * stats->hits / lookups : 0.0,
+           stats->revalidated, stats->misses, stats->invalidated, stats->evictions);
+}
@@ -0,0 +1,108 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file route_tree.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/route_tree.h"
+
+// 头部之后依次是索引表、距离、前驱与 ID，均按 4 字节对齐，一次分配
+RouteTree* snapshot_route_tree(const GraphSnapshot *snap, int source_id, RouteProfile profile) {
+    if (!snap || !snap->index.entries) return NULL;
+
+    int source_slot = GraphSnapshotGetSlot(snap, source_id);
+    if (source_slot == GRAPH_INVALID_SLOT) return NULL;
+
+    size_t index_size = (snap->index.mask + 1) * sizeof(GraphIndexEntry);
+    size_t slot_size = (size_t)snap->slot_count * (sizeof(float) + sizeof(int) * 2);
+    RouteTree *tree = (RouteTree*)MALLOC_S(sizeof(RouteTree) + index_size + slot_size);
+    if (!tree) return NULL;
+
+    tree->index.entries = (GraphIndexEntry*)(tree + 1);
+    tree->distances = (float*)((char*)tree->index.entries + index_size);
+    tree->previous = (int*)(tree->distances + snap->slot_count);
+    tree->ids = tree->previous + snap->slot_count;
+
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    bool ok = snapshot_dijkstra_profile(snap, profile, source_slot, GRAPH_INVALID_SLOT, scratch,
+                                        tree->distances, tree->previous);
+    mem_arena_release(scratch, mark);
+    if (!ok) {
+        FREE_S(tree);
+        return NULL;
+    }
+
+    memcpy(tree->index.entries, snap->index.entries, index_size);
+    tree->index.mask = snap->index.mask;
+    tree->index.count = snap->index.count;
+    memcpy(tree->ids, snap->ids, (size_t)snap->slot_count * sizeof(int));
+
+    tree->version = snap->version;
+    tree->profile = profile;
+    tree->source_slot = source_slot;
+    tree->slot_count = snap->slot_count;
+    return tree;
+}
+
+RouteTree* graph_route_tree(Graph *graph, int source_id, RouteProfile profile) {
+    return snapshot_route_tree(GraphGetSnapshot(graph), source_id, profile);
+}
+
+void route_tree_destroy(RouteTree *tree) {
+    if (!tree) return;
+
+    FREE_S(tree);
+}
+
+/*
+ * Writes the node ids from the source to dst_id into node_ids and returns
+ * the node count. 0 when unreachable or unknown. When the path needs more
+ * than capacity entries nothing is written and the needed count is returned.
+ */
+int route_tree_path(const RouteTree *tree, int dst_id, int *node_ids, int capacity) {
+    int slot = GraphIndexFind(&tree->index, dst_id);
+    if (slot == GRAPH_INVALID_SLOT || tree->distances[slot] == FLT_MAX) return 0;
+
+    int length = 1;
+    for (int current = slot; current != tree->source_slot; current = tree->previous[current]) {
+        length++;
+    }
+    if (length > capacity) return length;
+
+    for (int i = length - 1, current = slot; i >= 0; i--, current = tree->previous[current]) {
+        node_ids[i] = tree->ids[current];
+    }
+    return length;
+}
+
+/* First node after the source towards dst_id, GRAPH_INVALID_ID when unreachable or dst_id is the source */
+int route_tree_first_hop(const RouteTree *tree, int dst_id) {
+    int slot = GraphIndexFind(&tree->index, dst_id);
+    if (slot == GRAPH_INVALID_SLOT || slot == tree->source_slot || tree->distances[slot] == FLT_MAX) {
+        return GRAPH_INVALID_ID;
+    }
+
+    while (tree->previous[slot] != tree->source_slot) {
+        slot = tree->previous[slot];
+    }
+    return tree->ids[slot];
+}
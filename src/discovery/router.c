@@ -1,15 +1,34 @@
 #include "discovery/router.h"
+#include "discovery/path_set.h"
+#include "discovery/landmark.h"
+#include "discovery/topology.h"
+#include "util/bitset.h"
+#include "util/heap.h"
 
-extern Graph* g_dev_topology;
-extern GraphNode* g_cur_dev;
+// 路径对象池，可能在多个线程中创建和释放
+static MemPool g_path_pool = MEM_POOL_INITIALIZER("path", Path, 128, true);
+static MemPool g_path_edges_pool = MEM_POOL_INITIALIZER("path_with_edges", PathWithEdges, 64, true);
+static MemPool g_path_list_node_pool = MEM_POOL_INITIALIZER("path_list_node", PathListNode, 128, true);
+
+// 查询临时内存使用线程私有 arena，查询结束时整体回退
+MemArena* router_scratch(void) {
+    return mem_thread_arena();
+}
+
+void router_print_stats(void) {
+    mem_pool_print_stats(&g_path_pool);
+    mem_pool_print_stats(&g_path_edges_pool);
+    mem_pool_print_stats(&g_path_list_node_pool);
+    mem_arena_print_stats(router_scratch());
+}
 
 Path* path_create(int *node_ids, int length, float total_cost) {
-    Path *path = (Path*)MALLOC_S(sizeof(Path));
+    Path *path = POOL_ALLOC_S(&g_path_pool, Path);
     if (!path) return NULL;
     
     path->node_ids = (int*)MALLOC_S(length * sizeof(int));
     if (!path->node_ids) {
-        FREE_S(path);
+        POOL_FREE_S(&g_path_pool, path);
         return NULL;
     }
     
@@ -26,20 +45,20 @@ void path_destroy(Path *path) {
     if (path->node_ids) {
         FREE_S(path->node_ids);
     }
-    FREE_S(path);
+    POOL_FREE_S(&g_path_pool, path);
 }
 
 PathWithEdges* path_with_edges_create(GraphNode **nodes, EdgeData **edges, int length, float total_cost) {
-    PathWithEdges *path = (PathWithEdges*)MALLOC_S(sizeof(PathWithEdges));
+    PathWithEdges *path = POOL_ALLOC_S(&g_path_edges_pool, PathWithEdges);
     if (!path) return NULL;
     
     path->nodes = (GraphNode**)MALLOC_S(length * sizeof(GraphNode*));
-    path->edges = (EdgeData**)MALLOC_S((length - 1) * sizeof(EdgeData*));
+    path->edges = (EdgeData**)MALLOC_S(MAX(length - 1, 1) * sizeof(EdgeData*));
     
     if (!path->nodes || !path->edges) {
         if (path->nodes) FREE_S(path->nodes);
         if (path->edges) FREE_S(path->edges);
-        FREE_S(path);
+        POOL_FREE_S(&g_path_edges_pool, path);
         return NULL;
     }
     
@@ -59,7 +78,7 @@ void path_with_edges_destroy(PathWithEdges *path) {
     
     if (path->nodes) FREE_S(path->nodes);
     if (path->edges) FREE_S(path->edges);
-    FREE_S(path);
+    POOL_FREE_S(&g_path_edges_pool, path);
 }
 
 // 路径列表操作
@@ -76,7 +95,7 @@ PathList* path_list_create() {
 void path_list_add(PathList *list, Path *path) {
     if (!list || !path) return;
     
-    PathListNode *node = (PathListNode*)MALLOC_S(sizeof(PathListNode));
+    PathListNode *node = POOL_ALLOC_S(&g_path_list_node_pool, PathListNode);
     if (!node) return;
     
     node->path = path;
@@ -110,7 +129,7 @@ void path_list_remove(PathList *list, Path *path) {
                 list->tail = prev;
             }
             
-            FREE_S(current);
+            POOL_FREE_S(&g_path_list_node_pool, current);
             list->count--;
             return;
         }
@@ -127,7 +146,7 @@ void path_list_destroy(PathList *list) {
     while (current) {
         PathListNode *next = current->next;
         path_destroy(current->path);
-        FREE_S(current);
+        POOL_FREE_S(&g_path_list_node_pool, current);
         current = next;
     }
     
@@ -140,9 +159,9 @@ void path_print(Path *path, Graph *graph) {
     
     printf("Path (cost: %.2f): ", path->total_cost);
     for (int i = 0; i < path->length; i++) {
-        GraphNode *node = graph_get_node(graph, path->node_ids[i]);
-        if (node) {
-            printf("%s", node->data.hostname);
+        Device *device = GraphGetDevice(graph, path->node_ids[i]);
+        if (device) {
+            printf("%s", str_get(device->hostname));
         } else {
             printf("[%d]", path->node_ids[i]);
         }
@@ -154,12 +173,12 @@ void path_print(Path *path, Graph *graph) {
     printf("\n");
 }
 
-void path_with_edges_print(PathWithEdges *path) {
-    if (!path) return;
+void path_with_edges_print(PathWithEdges *path, Graph *graph) {
+    if (!path || !graph) return;
     
     printf("Path (cost: %.2f): ", path->total_cost);
     for (int i = 0; i < path->length; i++) {
-        printf("%s", path->nodes[i]->data.hostname);
+        printf("%s", str_get(GraphNodeDevice(graph, path->nodes[i])->hostname));
         
         if (i < path->length - 1) {
             printf(" -(%.2f)-> ", path->edges[i]->latency);
@@ -169,103 +188,992 @@ void path_with_edges_print(PathWithEdges *path) {
 }
 
 // 路径查找算法
-Path* graph_find_shortest_path(Graph *graph, int start_id, int end_id) {
-    if (!graph) return NULL;
-    
-    // 使用Dijkstra算法查找最短路径
-    int node_count = graph->node_count;
-    float *distances = (float*)MALLOC_S(node_count * sizeof(float));
-    int *previous = (int*)MALLOC_S(node_count * sizeof(int));
-    bool *visited = (bool*)MALLOC_S(node_count * sizeof(bool));
-    
-    if (!distances || !previous || !visited) {
-        if (distances) FREE_S(distances);
-        if (previous) FREE_S(previous);
-        if (visited) FREE_S(visited);
-        return NULL;
-    }
-    
-    // 初始化
-    for (int i = 0; i < node_count; i++) {
+// Dijkstra：按槽位索引的距离与前驱，d 叉堆支持降键，只有入堆节点被访问
+// 到达 end_slot 后提前结束，end_slot 为 GRAPH_INVALID_SLOT 时求完整最短路径树
+// 可选禁用节点与禁用边（CSR 边下标），为 NULL 时内联后检查被消除
+// 成本：custom 非空时走函数指针，否则按 profile 计算；profile 为常量时内联为对应的成本函数
+static inline ATTR_ALWAYS_INLINE bool snapshot_dijkstra_masked(const GraphSnapshot *snap, int start_slot, int end_slot,
+                                                               MemArena *scratch, float *distances, int *previous,
+                                                               const Bitset *banned_nodes, const Bitset *banned_edges,
+                                                               RouteProfile profile, RouteCostFn custom, void *arg) {
+    IndexedHeap heap;
+    if (!heap_arena_init(&heap, scratch, snap->slot_count)) return false;
+
+    for (int i = 0; i < snap->slot_count; i++) {
         distances[i] = FLT_MAX;
         previous[i] = -1;
-        visited[i] = false;
     }
-    
-    distances[start_id] = 0;
-    
-    // 主循环
-    for (int i = 0; i < node_count - 1; i++) {
-        // 找到未访问的最小距离节点
-        float min_distance = FLT_MAX;
-        int min_index = -1;
-        
-        for (int j = 0; j < node_count; j++) {
-            if (!visited[j] && distances[j] < min_distance) {
-                min_distance = distances[j];
-                min_index = j;
-            }
-        }
-        
-        if (min_index == -1) break;
-        visited[min_index] = true;
-        
-        // 更新邻居节点的距离
-        GraphNode *node = graph_get_node(graph, min_index);
-        for (int j = 0; j < node->neighbor_count; j++) {
-            GraphNode *neighbor = node->neighbors[j];
-            EdgeData *edge = node->edge_data[j];
-            float alt = distances[min_index] + edge->latency; // 使用延迟作为成本
-            
-            if (alt < distances[neighbor->id]) {
-                distances[neighbor->id] = alt;
-                previous[neighbor->id] = min_index;
+
+    distances[start_slot] = 0;
+    heap_push_or_decrease(&heap, start_slot, 0);
+
+    while (!heap_empty(&heap)) {
+        float distance;
+        int current = heap_pop(&heap, &distance);
+        if (current == end_slot) break;
+
+        // 更新邻居节点的距离，邻接与边权在 CSR 中顺序存放
+        for (int e = snap->offsets[current]; e < snap->offsets[current + 1]; e++) {
+            int neighbor = snap->targets[e];
+            if (banned_edges && bitset_test(banned_edges, e)) continue;
+            if (banned_nodes && bitset_test(banned_nodes, neighbor)) continue;
+
+            float alt = distance + (custom ? custom(snap, e, arg) : route_cost(snap, e, profile));
+            if (alt < distances[neighbor] && !heap_popped(&heap, neighbor)) {
+                distances[neighbor] = alt;
+                previous[neighbor] = current;
+                heap_push_or_decrease(&heap, neighbor, alt);
             }
         }
     }
+    return true;
+}
+
+bool snapshot_dijkstra(const GraphSnapshot *snap, int start_slot, int end_slot, MemArena *scratch,
+                       float *distances, int *previous) {
+    return snapshot_dijkstra_masked(snap, start_slot, end_slot, scratch, distances, previous, NULL, NULL,
+                                    ROUTE_PROFILE_LATENCY, NULL, NULL);
+}
+
+// 每个分支的 profile 都是常量，各自展开一份没有间接调用的松弛循环
+bool snapshot_dijkstra_profile(const GraphSnapshot *snap, RouteProfile profile, int start_slot, int end_slot,
+                               MemArena *scratch, float *distances, int *previous) {
+    switch (profile) {
+        case ROUTE_PROFILE_INTERACTIVE:
+            return snapshot_dijkstra_masked(snap, start_slot, end_slot, scratch, distances, previous, NULL, NULL,
+                                            ROUTE_PROFILE_INTERACTIVE, NULL, NULL);
+        case ROUTE_PROFILE_BULK:
+            return snapshot_dijkstra_masked(snap, start_slot, end_slot, scratch, distances, previous, NULL, NULL,
+                                            ROUTE_PROFILE_BULK, NULL, NULL);
+        case ROUTE_PROFILE_CONTROL:
+            return snapshot_dijkstra_masked(snap, start_slot, end_slot, scratch, distances, previous, NULL, NULL,
+                                            ROUTE_PROFILE_CONTROL, NULL, NULL);
+        default:
+            return snapshot_dijkstra(snap, start_slot, end_slot, scratch, distances, previous);
+    }
+}
+
+bool snapshot_dijkstra_custom(const GraphSnapshot *snap, RouteCostFn cost, void *arg, int start_slot, int end_slot,
+                              MemArena *scratch, float *distances, int *previous) {
+    return snapshot_dijkstra_masked(snap, start_slot, end_slot, scratch, distances, previous, NULL, NULL,
+                                    ROUTE_PROFILE_LATENCY, cost, arg);
+}
+
+// cost 为空时按 profile 搜索
+static Path* router_find_path(const GraphSnapshot *snap, int start_id, int end_id, RouteProfile profile,
+                              RouteCostFn cost, void *arg) {
+    if (!snap) return NULL;
+    
+    int start_slot = GraphSnapshotGetSlot(snap, start_id);
+    int end_slot = GraphSnapshotGetSlot(snap, end_id);
+    if (start_slot == GRAPH_INVALID_SLOT || end_slot == GRAPH_INVALID_SLOT) return NULL;
+    
+    int slot_count = snap->slot_count;
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    float *distances = ARENA_ALLOC_S(scratch, slot_count, float);
+    int *previous = ARENA_ALLOC_S(scratch, slot_count, int);
+    
+    bool ok = distances && previous &&
+              (cost ? snapshot_dijkstra_custom(snap, cost, arg, start_slot, end_slot, scratch, distances, previous)
+                    : snapshot_dijkstra_profile(snap, profile, start_slot, end_slot, scratch, distances, previous));
+    if (!ok) {
+        mem_arena_release(scratch, mark);
+        return NULL;
+    }
     
     // 构建路径
-    if (distances[end_id] == FLT_MAX) {
+    if (distances[end_slot] == FLT_MAX) {
         // 没有路径
-        FREE_S(distances);
-        FREE_S(previous);
-        FREE_S(visited);
+        mem_arena_release(scratch, mark);
         return NULL;
     }
     
     // 计算路径长度
     int path_length = 1;
-    int current = end_id;
-    while (current != start_id) {
+    int current = end_slot;
+    while (current != start_slot) {
         path_length++;
         current = previous[current];
     }
     
     // 创建路径数组
-    int *path_nodes = (int*)MALLOC_S(path_length * sizeof(int));
+    int *path_nodes = ARENA_ALLOC_S(scratch, path_length, int);
     if (!path_nodes) {
-        FREE_S(distances);
-        FREE_S(previous);
-        FREE_S(visited);
+        mem_arena_release(scratch, mark);
         return NULL;
     }
     
-    current = end_id;
+    current = end_slot;
     for (int i = path_length - 1; i >= 0; i--) {
-        path_nodes[i] = current;
+        path_nodes[i] = snap->ids[current];
         current = previous[current];
     }
     
-    Path *path = path_create(path_nodes, path_length, distances[end_id]);
+    Path *path = path_create(path_nodes, path_length, distances[end_slot]);
     
-    FREE_S(distances);
-    FREE_S(previous);
-    FREE_S(visited);
-    FREE_S(path_nodes);
+    mem_arena_release(scratch, mark);
     
     return path;
 }
 
+Path* snapshot_find_shortest_path(const GraphSnapshot *snap, int start_id, int end_id) {
+    return router_find_path(snap, start_id, end_id, ROUTE_PROFILE_LATENCY, NULL, NULL);
+}
+
+Path* snapshot_find_route(const GraphSnapshot *snap, int start_id, int end_id, RouteProfile profile) {
+    return router_find_path(snap, start_id, end_id, profile, NULL, NULL);
+}
+
+Path* snapshot_find_route_custom(const GraphSnapshot *snap, int start_id, int end_id, RouteCostFn cost, void *arg) {
+    if (!cost) return NULL;
+    return router_find_path(snap, start_id, end_id, ROUTE_PROFILE_LATENCY, cost, arg);
+}
+
+// K 条最短无环路径，候选与结果的槽位序列都放在线程 arena 中
+typedef struct RouterCandidate_ {
+    int *slots;
+    int length;
+    float cost;
+} RouterCandidate;
+
+typedef struct RouterKPaths_ {
+    const GraphSnapshot *snap;
+    MemArena *scratch;
+    float *distances;
+    int *previous;
+    Bitset banned_nodes;
+    Bitset banned_edges;        /* By CSR edge index */
+    RouterCandidate *found;
+    int found_count;
+    RouterCandidate *candidates;
+    int candidate_count;
+    int candidate_capacity;
+} RouterKPaths;
+
+static int snapshot_edge_index(const GraphSnapshot *snap, int from_slot, int to_slot) {
+    for (int e = snap->offsets[from_slot]; e < snap->offsets[from_slot + 1]; e++) {
+        if (snap->targets[e] == to_slot) return e;
+    }
+    return -1;
+}
+
+static void router_bitset_reset(Bitset *set) {
+    memset(set->words, 0, BITSET_WORDS(set->nbits) * sizeof(uint64_t));
+}
+
+// 搜索 spur -> end，结果接在 prefix 之后；堆空间每轮回退，路径保留在 arena 中
+static bool router_search(RouterKPaths *k, int spur, int end, const int *prefix, int prefix_length,
+                          float prefix_cost, bool mask_nodes, RouterCandidate *out) {
+    MemArenaMark round = mem_arena_mark(k->scratch);
+    bool ok = snapshot_dijkstra_masked(k->snap, spur, end, k->scratch, k->distances, k->previous,
+                                       mask_nodes ? &k->banned_nodes : NULL, &k->banned_edges,
+                                       ROUTE_PROFILE_LATENCY, NULL, NULL);
+    mem_arena_release(k->scratch, round);
+    if (!ok || k->distances[end] == FLT_MAX) return false;
+
+    int length = prefix_length + 1;
+    for (int current = end; current != spur; current = k->previous[current]) {
+        length++;
+    }
+
+    int *slots = ARENA_ALLOC_S(k->scratch, length, int);
+    if (!slots) return false;
+
+    if (prefix_length > 0) {
+        memcpy(slots, prefix, prefix_length * sizeof(int));
+    }
+    int current = end;
+    for (int i = length - 1; i >= prefix_length; i--) {
+        slots[i] = current;
+        current = k->previous[current];
+    }
+
+    out->slots = slots;
+    out->length = length;
+    out->cost = prefix_cost + k->distances[end];
+    return true;
+}
+
+static bool router_same_path(const RouterCandidate *a, const RouterCandidate *b) {
+    return a->length == b->length && memcmp(a->slots, b->slots, a->length * sizeof(int)) == 0;
+}
+
+static bool router_add_candidate(RouterKPaths *k, const RouterCandidate *candidate) {
+    for (int i = 0; i < k->candidate_count; i++) {
+        if (router_same_path(&k->candidates[i], candidate)) return true;
+    }
+    for (int i = 0; i < k->found_count; i++) {
+        if (router_same_path(&k->found[i], candidate)) return true;
+    }
+
+    if (k->candidate_count >= k->candidate_capacity) {
+        int capacity = k->candidate_capacity ? k->candidate_capacity * 2 : 16;
+        RouterCandidate *grown = ARENA_ALLOC_S(k->scratch, capacity, RouterCandidate);
+        if (!grown) return false;
+
+        if (k->candidate_count > 0) {
+            memcpy(grown, k->candidates, k->candidate_count * sizeof(RouterCandidate));
+        }
+        k->candidates = grown;
+        k->candidate_capacity = capacity;
+    }
+    k->candidates[k->candidate_count++] = *candidate;
+    return true;
+}
+
+// Yen：对上一条路径的每个偏离点，禁用共享同一前缀的已选路径的下一条边和前缀节点后搜索
+static void router_yen(RouterKPaths *k, int start, int end, int max_paths) {
+    if (!router_search(k, start, end, NULL, 0, 0, false, &k->found[0])) return;
+    k->found_count = 1;
+
+    while (k->found_count < max_paths) {
+        const RouterCandidate *last = &k->found[k->found_count - 1];
+        float root_cost = 0;
+
+        for (int j = 0; j + 1 < last->length; j++) {
+            router_bitset_reset(&k->banned_nodes);
+            router_bitset_reset(&k->banned_edges);
+            for (int p = 0; p < k->found_count; p++) {
+                const RouterCandidate *path = &k->found[p];
+                if (path->length > j + 1 && memcmp(path->slots, last->slots, (j + 1) * sizeof(int)) == 0) {
+                    bitset_set(&k->banned_edges, snapshot_edge_index(k->snap, path->slots[j], path->slots[j + 1]));
+                }
+            }
+            for (int r = 0; r < j; r++) {
+                bitset_set(&k->banned_nodes, last->slots[r]);
+            }
+
+            RouterCandidate candidate;
+            if (router_search(k, last->slots[j], end, last->slots, j, root_cost, true, &candidate) &&
+                !router_add_candidate(k, &candidate)) {
+                return;
+            }
+            root_cost += k->snap->latency[snapshot_edge_index(k->snap, last->slots[j], last->slots[j + 1])];
+        }
+
+        if (k->candidate_count == 0) break;
+
+        // 取成本最低的候选，相同时取跳数少的
+        int best = 0;
+        for (int i = 1; i < k->candidate_count; i++) {
+            const RouterCandidate *c = &k->candidates[i];
+            if (c->cost < k->candidates[best].cost ||
+                (c->cost == k->candidates[best].cost && c->length < k->candidates[best].length)) {
+                best = i;
+            }
+        }
+        k->found[k->found_count++] = k->candidates[best];
+        k->candidates[best] = k->candidates[--k->candidate_count];
+    }
+}
+
+// 边不相交（Suurballe/Bhandari）：在残量图上逐条增广最短路径，已用的边只能反向走并取负成本
+// 反向走一条已用边即抵消它，最后从起点沿剩余的已用边分解出路径，总成本最小且条数不会被贪心选择卡住
+typedef struct RouterResidual_ {
+    const GraphSnapshot *snap;
+    Bitset flow;                /* By CSR edge index, edge carries a path */
+    int *sources;               /* CSR edge -> source slot */
+    int *in_offsets;            /* Incoming edges per slot, slot_count + 1 entries */
+    int *in_edges;
+    float *potential;           /* Keeps reduced costs non-negative */
+    int *via;                   /* Slot -> CSR edge it was reached through, -1 at start */
+} RouterResidual;
+
+static bool router_residual_init(RouterResidual *r, const GraphSnapshot *snap, MemArena *scratch) {
+    int slot_count = snap->slot_count;
+    int edge_count = snap->edge_count;
+    r->snap = snap;
+    r->sources = ARENA_ALLOC_S(scratch, MAX(edge_count, 1), int);
+    r->in_offsets = ARENA_ALLOC_S(scratch, slot_count + 1, int);
+    r->in_edges = ARENA_ALLOC_S(scratch, MAX(edge_count, 1), int);
+    r->potential = ARENA_ALLOC_S(scratch, slot_count, float);
+    r->via = ARENA_ALLOC_S(scratch, slot_count, int);
+    if (!r->sources || !r->in_offsets || !r->in_edges || !r->potential || !r->via ||
+        !bitset_arena_init(&r->flow, scratch, MAX(edge_count, 1))) {
+        return false;
+    }
+
+    // 按目标计数后前缀和，得到入边的 CSR
+    memset(r->in_offsets, 0, (slot_count + 1) * sizeof(int));
+    for (int u = 0; u < slot_count; u++) {
+        for (int e = snap->offsets[u]; e < snap->offsets[u + 1]; e++) {
+            r->sources[e] = u;
+            r->in_offsets[snap->targets[e] + 1]++;
+        }
+    }
+    for (int u = 0; u < slot_count; u++) {
+        r->in_offsets[u + 1] += r->in_offsets[u];
+        r->potential[u] = 0;
+    }
+    int *fill = r->via;  // 借用作写入游标
+    memcpy(fill, r->in_offsets, slot_count * sizeof(int));
+    for (int e = 0; e < edge_count; e++) {
+        r->in_edges[fill[snap->targets[e]]++] = e;
+    }
+    return true;
+}
+
+static inline void router_residual_relax(RouterResidual *r, IndexedHeap *heap, float *distances, int current,
+                                         int next, int e, float cost) {
+    if (heap_popped(heap, next)) return;
+
+    // 浮点误差可能让约化成本略小于 0
+    float reduced = MAX(cost + r->potential[current] - r->potential[next], 0.0f);
+    float alt = distances[current] + reduced;
+    if (alt < distances[next]) {
+        distances[next] = alt;
+        r->via[next] = e;
+        heap_push_or_decrease(heap, next, alt);
+    }
+}
+
+// 带势能的 Dijkstra；到达 end 后停止，未出堆的节点势能按 end 的距离截断，约化成本仍非负
+static bool router_residual_search(RouterResidual *r, MemArena *scratch, float *distances, int start, int end) {
+    const GraphSnapshot *snap = r->snap;
+    IndexedHeap heap;
+    if (!heap_arena_init(&heap, scratch, snap->slot_count)) return false;
+
+    for (int i = 0; i < snap->slot_count; i++) {
+        distances[i] = FLT_MAX;
+        r->via[i] = -1;
+    }
+    distances[start] = 0;
+    heap_push_or_decrease(&heap, start, 0);
+
+    while (!heap_empty(&heap)) {
+        float distance;
+        int current = heap_pop(&heap, &distance);
+        if (current == end) break;
+
+        for (int e = snap->offsets[current]; e < snap->offsets[current + 1]; e++) {
+            if (snap->targets[e] != current && !bitset_test(&r->flow, e)) {
+                router_residual_relax(r, &heap, distances, current, snap->targets[e], e, snap->latency[e]);
+            }
+        }
+        for (int i = r->in_offsets[current]; i < r->in_offsets[current + 1]; i++) {
+            int e = r->in_edges[i];
+            if (r->sources[e] != current && bitset_test(&r->flow, e)) {
+                router_residual_relax(r, &heap, distances, current, r->sources[e], e, -snap->latency[e]);
+            }
+        }
+    }
+    if (distances[end] == FLT_MAX) return false;
+
+    for (int i = 0; i < snap->slot_count; i++) {
+        r->potential[i] += heap_popped(&heap, i) ? distances[i] : distances[end];
+    }
+    return true;
+}
+
+// 沿 via 从 end 回到 start：正向边加入，反向边抵消；同一条边两个方向都被占用时一并抵消
+static void router_residual_augment(RouterResidual *r, int start, int end) {
+    const GraphSnapshot *snap = r->snap;
+    for (int current = end; current != start;) {
+        int e = r->via[current];
+        if (snap->targets[e] == current) {
+            int twin = snapshot_edge_index(snap, current, r->sources[e]);
+            if (twin >= 0 && bitset_test(&r->flow, twin)) {
+                bitset_clear(&r->flow, twin);
+            } else {
+                bitset_set(&r->flow, e);
+            }
+            current = r->sources[e];
+        } else {
+            bitset_clear(&r->flow, e);
+            current = snap->targets[e];
+        }
+    }
+}
+
+// 从 start 沿已用边走到 end，走过的边清除；重复经过的节点说明有环，截掉环
+static bool router_residual_take(RouterResidual *r, MemArena *scratch, int *position, int start, int end,
+                                 RouterCandidate *out) {
+    const GraphSnapshot *snap = r->snap;
+    int *slots = ARENA_ALLOC_S(scratch, snap->slot_count, int);
+    if (!slots) return false;
+
+    int length = 0;
+    int current = start;
+    slots[length++] = current;
+    position[current] = 0;
+    while (current != end) {
+        int next = -1;
+        for (int e = snap->offsets[current]; e < snap->offsets[current + 1]; e++) {
+            if (bitset_test(&r->flow, e)) {
+                bitset_clear(&r->flow, e);
+                next = snap->targets[e];
+                break;
+            }
+        }
+        if (next < 0) break;
+
+        if (position[next] >= 0) {
+            while (length > position[next] + 1) {
+                position[slots[--length]] = -1;
+            }
+        } else {
+            position[next] = length;
+            slots[length++] = next;
+        }
+        current = next;
+    }
+    for (int i = 0; i < length; i++) {
+        position[slots[i]] = -1;
+    }
+    if (current != end) return false;
+
+    float cost = 0;
+    for (int i = 0; i + 1 < length; i++) {
+        cost += snap->latency[snapshot_edge_index(snap, slots[i], slots[i + 1])];
+    }
+    out->slots = slots;
+    out->length = length;
+    out->cost = cost;
+    return true;
+}
+
+static void router_disjoint(RouterKPaths *k, int start, int end, int max_paths) {
+    if (start == end) {
+        if (router_search(k, start, end, NULL, 0, 0, false, &k->found[0])) {
+            k->found_count = 1;
+        }
+        return;
+    }
+
+    RouterResidual residual;
+    if (!router_residual_init(&residual, k->snap, k->scratch)) return;
+
+    int flows = 0;
+    while (flows < max_paths) {
+        MemArenaMark round = mem_arena_mark(k->scratch);
+        bool found = router_residual_search(&residual, k->scratch, k->distances, start, end);
+        mem_arena_release(k->scratch, round);
+        if (!found) break;
+
+        router_residual_augment(&residual, start, end);
+        flows++;
+    }
+
+    // 复用 previous 记录节点在当前路径中的位置
+    int *position = k->previous;
+    for (int i = 0; i < k->snap->slot_count; i++) {
+        position[i] = -1;
+    }
+    while (k->found_count < flows &&
+           router_residual_take(&residual, k->scratch, position, start, end, &k->found[k->found_count])) {
+        k->found_count++;
+    }
+
+    // 按成本升序，相同时跳数少的在前
+    for (int i = 1; i < k->found_count; i++) {
+        RouterCandidate path = k->found[i];
+        int j = i;
+        while (j > 0 && (k->found[j - 1].cost > path.cost ||
+                         (k->found[j - 1].cost == path.cost && k->found[j - 1].length > path.length))) {
+            k->found[j] = k->found[j - 1];
+            j--;
+        }
+        k->found[j] = path;
+    }
+}
+
+/*
+ * Up to max_paths loopless paths from start_id to end_id in increasing cost
+ * (Yen), or when edge_disjoint the largest set of up to max_paths paths
+ * sharing no edge with the least total cost (Suurballe/Bhandari).
+ * Returns an empty list when unreachable, NULL on error.
+ */
+// 结果留在 k->found 中，槽位已转换为节点 ID；调用者负责回退 arena
+static bool router_k_paths(RouterKPaths *k, const GraphSnapshot *snap, int start_id, int end_id, int max_paths,
+                           bool edge_disjoint) {
+    if (!snap || max_paths <= 0) return false;
+
+    int start_slot = GraphSnapshotGetSlot(snap, start_id);
+    int end_slot = GraphSnapshotGetSlot(snap, end_id);
+    if (start_slot == GRAPH_INVALID_SLOT || end_slot == GRAPH_INVALID_SLOT) return false;
+
+    memset(k, 0, sizeof(RouterKPaths));
+    k->snap = snap;
+    k->scratch = router_scratch();
+    k->distances = ARENA_ALLOC_S(k->scratch, snap->slot_count, float);
+    k->previous = ARENA_ALLOC_S(k->scratch, snap->slot_count, int);
+    k->found = ARENA_ALLOC_S(k->scratch, max_paths, RouterCandidate);
+    if (!k->distances || !k->previous || !k->found ||
+        !bitset_arena_init(&k->banned_nodes, k->scratch, snap->slot_count) ||
+        !bitset_arena_init(&k->banned_edges, k->scratch, MAX(snap->edge_count, 1))) {
+        return false;
+    }
+
+    if (edge_disjoint) {
+        router_disjoint(k, start_slot, end_slot, max_paths);
+    } else {
+        router_yen(k, start_slot, end_slot, max_paths);
+    }
+
+    // 槽位转换为节点 ID，原地改写
+    for (int i = 0; i < k->found_count; i++) {
+        for (int j = 0; j < k->found[i].length; j++) {
+            k->found[i].slots[j] = snap->ids[k->found[i].slots[j]];
+        }
+    }
+    return true;
+}
+
+PathList* snapshot_find_k_shortest_paths(const GraphSnapshot *snap, int start_id, int end_id, int max_paths,
+                                         bool edge_disjoint) {
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    RouterKPaths k;
+    if (!router_k_paths(&k, snap, start_id, end_id, max_paths, edge_disjoint)) {
+        mem_arena_release(scratch, mark);
+        return NULL;
+    }
+
+    PathList *list = path_list_create();
+    for (int i = 0; list && i < k.found_count; i++) {
+        Path *path = path_create(k.found[i].slots, k.found[i].length, k.found[i].cost);
+        if (path) {
+            path_list_add(list, path);
+        }
+    }
+
+    mem_arena_release(scratch, mark);
+    return list;
+}
+
+// 追加到 out，按代价升序；返回找到的条数，失败返回 -1
+int snapshot_find_k_shortest_paths_into(const GraphSnapshot *snap, int start_id, int end_id, int max_paths,
+                                        bool edge_disjoint, PathSet *out) {
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    RouterKPaths k;
+    if (!out || !router_k_paths(&k, snap, start_id, end_id, max_paths, edge_disjoint)) {
+        mem_arena_release(scratch, mark);
+        return -1;
+    }
+
+    int ids = 0;
+    for (int i = 0; i < k.found_count; i++) {
+        ids += k.found[i].length;
+    }
+    if (!path_set_reserve(out, k.found_count, ids)) {
+        mem_arena_release(scratch, mark);
+        return -1;
+    }
+    for (int i = 0; i < k.found_count; i++) {
+        path_set_add(out, k.found[i].slots, k.found[i].length, k.found[i].cost);
+    }
+
+    mem_arena_release(scratch, mark);
+    return k.found_count;
+}
+
+// 批量查询：第 i 条结果对应第 i 个查询，不可达时为空路径
+// 路径先暂存在线程 arena，最后一次性预留结果集空间；相邻查询同源时复用完整最短路径树
+int snapshot_find_routes(const GraphSnapshot *snap, const int *src_ids, const int *dst_ids, int count,
+                         RouteProfile profile, PathSet *out) {
+    if (!snap || !out || count < 0) return -1;
+
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    float *distances = ARENA_ALLOC_S(scratch, snap->slot_count, float);
+    int *previous = ARENA_ALLOC_S(scratch, snap->slot_count, int);
+    RouterCandidate *routes = ARENA_ALLOC_S(scratch, MAX(count, 1), RouterCandidate);
+    if (!distances || !previous || !routes) {
+        mem_arena_release(scratch, mark);
+        return -1;
+    }
+
+    int tree_slot = GRAPH_INVALID_SLOT;  // 当前完整树的源
+    int ids = 0;
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        RouterCandidate *route = &routes[i];
+        route->slots = NULL;
+        route->length = 0;
+        route->cost = 0;
+
+        int start_slot = GraphSnapshotGetSlot(snap, src_ids[i]);
+        int end_slot = GraphSnapshotGetSlot(snap, dst_ids[i]);
+        if (start_slot == GRAPH_INVALID_SLOT || end_slot == GRAPH_INVALID_SLOT) continue;
+
+        if (start_slot != tree_slot) {
+            bool shared = i + 1 < count && src_ids[i + 1] == src_ids[i];
+            MemArenaMark round = mem_arena_mark(scratch);
+            bool ok = snapshot_dijkstra_profile(snap, profile, start_slot, shared ? GRAPH_INVALID_SLOT : end_slot,
+                                                scratch, distances, previous);
+            mem_arena_release(scratch, round);
+            if (!ok) {
+                mem_arena_release(scratch, mark);
+                return -1;
+            }
+            tree_slot = shared ? start_slot : GRAPH_INVALID_SLOT;
+        }
+        if (distances[end_slot] == FLT_MAX) continue;
+
+        int length = 1;
+        for (int current = end_slot; current != start_slot; current = previous[current]) {
+            length++;
+        }
+        route->slots = ARENA_ALLOC_S(scratch, length, int);
+        if (!route->slots) {
+            mem_arena_release(scratch, mark);
+            return -1;
+        }
+        int current = end_slot;
+        for (int j = length - 1; j >= 0; j--) {
+            route->slots[j] = snap->ids[current];
+            current = previous[current];
+        }
+        route->length = length;
+        route->cost = distances[end_slot];
+        ids += length;
+        found++;
+    }
+
+    if (!path_set_reserve(out, count, ids)) {
+        mem_arena_release(scratch, mark);
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        path_set_add(out, routes[i].slots, routes[i].length, routes[i].cost);
+    }
+
+    mem_arena_release(scratch, mark);
+    return found;
+}
+
+// 点对点搜索：双向 Dijkstra 与 ALT（A* + 地标下界），settled 返回出堆的节点数
+// start -> meet 沿 previous 回溯，meet -> end 沿 next（反向树的后继），next 为 NULL 时 meet 即 end
+static Path* router_path_create(const GraphSnapshot *snap, MemArena *scratch, const int *previous, const int *next,
+                                int start_slot, int meet_slot, int end_slot, float cost) {
+    int length = 1;
+    for (int current = meet_slot; current != start_slot; current = previous[current]) {
+        length++;
+    }
+    int head = length;
+    for (int current = meet_slot; next && current != end_slot; current = next[current]) {
+        length++;
+    }
+
+    int *node_ids = ARENA_ALLOC_S(scratch, length, int);
+    if (!node_ids) return NULL;
+
+    int current = meet_slot;
+    for (int i = head - 1; i >= 0; i--) {
+        node_ids[i] = snap->ids[current];
+        current = previous[current];
+    }
+    current = meet_slot;
+    for (int i = head; i < length; i++) {
+        current = next[current];
+        node_ids[i] = snap->ids[current];
+    }
+    return path_create(node_ids, length, cost);
+}
+
+// landmarks 为 NULL 时势函数为 0，即普通 Dijkstra；下界一致，节点出堆后不会再被改进
+static Path* router_astar(const GraphSnapshot *snap, const LandmarkTable *landmarks, int start_slot, int end_slot,
+                          int *settled) {
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    int slot_count = snap->slot_count;
+    float *distances = ARENA_ALLOC_S(scratch, slot_count, float);
+    float *bounds = ARENA_ALLOC_S(scratch, slot_count, float);
+    int *previous = ARENA_ALLOC_S(scratch, slot_count, int);
+    IndexedHeap heap;
+    if (!distances || !bounds || !previous || !heap_arena_init(&heap, scratch, slot_count)) {
+        mem_arena_release(scratch, mark);
+        return NULL;
+    }
+
+    for (int i = 0; i < slot_count; i++) {
+        distances[i] = FLT_MAX;
+        bounds[i] = -1;
+        previous[i] = -1;
+    }
+
+    int count = 0;
+    distances[start_slot] = 0;
+    heap_push_or_decrease(&heap, start_slot, 0);
+    while (!heap_empty(&heap)) {
+        int current = heap_pop(&heap, NULL);
+        count++;
+        if (current == end_slot) break;
+
+        float distance = distances[current];
+        for (int e = snap->offsets[current]; e < snap->offsets[current + 1]; e++) {
+            int neighbor = snap->targets[e];
+            float alt = distance + snap->latency[e];
+            if (alt < distances[neighbor] && !heap_popped(&heap, neighbor)) {
+                // 下界在首次到达时计算并缓存
+                if (bounds[neighbor] < 0) {
+                    bounds[neighbor] = landmarks ? landmark_bound(landmarks, neighbor, end_slot) : 0;
+                }
+                distances[neighbor] = alt;
+                previous[neighbor] = current;
+                heap_push_or_decrease(&heap, neighbor, alt + bounds[neighbor]);
+            }
+        }
+    }
+    if (settled) *settled = count;
+
+    Path *path = NULL;
+    if (distances[end_slot] != FLT_MAX) {
+        path = router_path_create(snap, scratch, previous, NULL, start_slot, end_slot, end_slot,
+                                  distances[end_slot]);
+    }
+    mem_arena_release(scratch, mark);
+    return path;
+}
+
+// 每轮扩展堆顶较小的一侧，两侧堆顶之和不小于已知最短路径时结束
+static Path* router_bidirectional(const GraphSnapshot *snap, const GraphSnapshot *reverse, int start_slot,
+                                  int end_slot, int *settled) {
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    int slot_count = snap->slot_count;
+    float *distances[2] = { ARENA_ALLOC_S(scratch, slot_count, float), ARENA_ALLOC_S(scratch, slot_count, float) };
+    int *parents[2] = { ARENA_ALLOC_S(scratch, slot_count, int), ARENA_ALLOC_S(scratch, slot_count, int) };
+    const GraphSnapshot *sides[2] = { snap, reverse };
+    IndexedHeap heaps[2];
+    if (!distances[0] || !distances[1] || !parents[0] || !parents[1] ||
+        !heap_arena_init(&heaps[0], scratch, slot_count) || !heap_arena_init(&heaps[1], scratch, slot_count)) {
+        mem_arena_release(scratch, mark);
+        return NULL;
+    }
+
+    for (int i = 0; i < slot_count; i++) {
+        distances[0][i] = distances[1][i] = FLT_MAX;
+        parents[0][i] = parents[1][i] = -1;
+    }
+
+    distances[0][start_slot] = 0;
+    distances[1][end_slot] = 0;
+    heap_push_or_decrease(&heaps[0], start_slot, 0);
+    heap_push_or_decrease(&heaps[1], end_slot, 0);
+
+    float best = start_slot == end_slot ? 0 : FLT_MAX;
+    int meet_slot = start_slot == end_slot ? start_slot : -1;
+    int count = 0;
+    while (!heap_empty(&heaps[0]) && !heap_empty(&heaps[1])) {
+        float forward_key = heap_min_key(&heaps[0]);
+        float backward_key = heap_min_key(&heaps[1]);
+        if (forward_key + backward_key >= best) break;
+
+        int side = forward_key <= backward_key ? 0 : 1;
+        const GraphSnapshot *graph = sides[side];
+        IndexedHeap *heap = &heaps[side];
+        float *distance = distances[side];
+        const float *other = distances[side ^ 1];
+        int *parent = parents[side];
+
+        float current_distance;
+        int current = heap_pop(heap, &current_distance);
+        count++;
+
+        for (int e = graph->offsets[current]; e < graph->offsets[current + 1]; e++) {
+            int neighbor = graph->targets[e];
+            float alt = current_distance + graph->latency[e];
+            if (alt < distance[neighbor] && !heap_popped(heap, neighbor)) {
+                distance[neighbor] = alt;
+                parent[neighbor] = current;
+                heap_push_or_decrease(heap, neighbor, alt);
+            }
+            // 按已记录的距离判断相遇，与前驱保持一致
+            if (other[neighbor] != FLT_MAX && distance[neighbor] + other[neighbor] < best) {
+                best = distance[neighbor] + other[neighbor];
+                meet_slot = neighbor;
+            }
+        }
+    }
+    if (settled) *settled = count;
+
+    Path *path = NULL;
+    if (meet_slot >= 0) {
+        path = router_path_create(snap, scratch, parents[0], parents[1], start_slot, meet_slot, end_slot, best);
+    }
+    mem_arena_release(scratch, mark);
+    return path;
+}
+
+// 有向图需要转置快照做反向搜索，缺少时退化为单向 Dijkstra
+Path* snapshot_find_path_bidirectional(const GraphSnapshot *snap, const GraphSnapshot *reverse, int start_id,
+                                       int end_id, int *settled) {
+    if (settled) *settled = 0;
+    if (!snap) return NULL;
+
+    int start_slot = GraphSnapshotGetSlot(snap, start_id);
+    int end_slot = GraphSnapshotGetSlot(snap, end_id);
+    if (start_slot == GRAPH_INVALID_SLOT || end_slot == GRAPH_INVALID_SLOT) return NULL;
+
+    if (!snap->directed) {
+        reverse = snap;
+    } else if (!reverse || reverse->version != snap->version) {
+        return router_astar(snap, NULL, start_slot, end_slot, settled);
+    }
+    return router_bidirectional(snap, reverse, start_slot, end_slot, settled);
+}
+
+// 地标表与快照版本不一致时下界不再成立，退化为双向搜索
+Path* snapshot_find_path_alt(const GraphSnapshot *snap, const LandmarkTable *landmarks, int start_id, int end_id,
+                             int *settled) {
+    if (settled) *settled = 0;
+    if (!snap) return NULL;
+
+    if (landmarks && landmarks->version != snap->version) {
+        return snapshot_find_path_bidirectional(snap, NULL, start_id, end_id, settled);
+    }
+
+    int start_slot = GraphSnapshotGetSlot(snap, start_id);
+    int end_slot = GraphSnapshotGetSlot(snap, end_id);
+    if (start_slot == GRAPH_INVALID_SLOT || end_slot == GRAPH_INVALID_SLOT) return NULL;
+
+    return router_astar(snap, landmarks, start_slot, end_slot, settled);
+}
+
+// 最宽路径：先求最大瓶颈带宽，再在带宽不低于瓶颈的边上求最短延迟路径
+// 只求瓶颈树时延迟不参与比较，否则瓶颈相同的路径中无法保证延迟最短
+bool snapshot_widest_tree(const GraphSnapshot *snap, int start_slot, MemArena *scratch,
+                          unsigned int *widths, int *previous) {
+    MemArenaMark mark = mem_arena_mark(scratch);
+    IndexedHeap heap;
+    if (!heap_arena_init(&heap, scratch, snap->slot_count)) {
+        mem_arena_release(scratch, mark);
+        return false;
+    }
+
+    for (int i = 0; i < snap->slot_count; i++) {
+        widths[i] = 0;
+        previous[i] = -1;
+    }
+
+    // 最小堆，键取带宽的相反数；带宽超过 float 精度（2^24 Mbps）时顺序才可能有偏差
+    widths[start_slot] = UINT_MAX;
+    heap_push_or_decrease(&heap, start_slot, -(float)UINT_MAX);
+
+    while (!heap_empty(&heap)) {
+        float key;
+        int current = heap_pop(&heap, &key);
+        unsigned int width = widths[current];
+
+        for (int e = snap->offsets[current]; e < snap->offsets[current + 1]; e++) {
+            int neighbor = snap->targets[e];
+            if (neighbor == start_slot || heap_popped(&heap, neighbor)) continue;
+
+            // 未测量的链路带宽为 0，仍然可达
+            unsigned int candidate = MIN(width, snap->bandwidth[e]);
+            if (previous[neighbor] == -1 || candidate > widths[neighbor]) {
+                widths[neighbor] = candidate;
+                previous[neighbor] = current;
+                heap_push_or_decrease(&heap, neighbor, -(float)candidate);
+            }
+        }
+    }
+
+    mem_arena_release(scratch, mark);
+    return true;
+}
+
+unsigned int* snapshot_bottlenecks(const GraphSnapshot *snap, int source_id) {
+    if (!snap) return NULL;
+
+    int source_slot = GraphSnapshotGetSlot(snap, source_id);
+    if (source_slot == GRAPH_INVALID_SLOT) return NULL;
+
+    unsigned int *widths = (unsigned int*)MALLOC_S(MAX(snap->slot_count, 1) * sizeof(unsigned int));
+    if (!widths) return NULL;
+
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    int *previous = ARENA_ALLOC_S(scratch, snap->slot_count, int);
+    if (!previous || !snapshot_widest_tree(snap, source_slot, scratch, widths, previous)) {
+        mem_arena_release(scratch, mark);
+        FREE_S(widths);
+        return NULL;
+    }
+
+    mem_arena_release(scratch, mark);
+    return widths;
+}
+
+PathWithEdges* graph_find_widest_path(Graph *graph, int start_id, int end_id) {
+    GraphSnapshot *snap = GraphGetSnapshot(graph);
+    if (!snap) return NULL;
+
+    int start_slot = GraphSnapshotGetSlot(snap, start_id);
+    int end_slot = GraphSnapshotGetSlot(snap, end_id);
+    if (start_slot == GRAPH_INVALID_SLOT || end_slot == GRAPH_INVALID_SLOT) return NULL;
+
+    int slot_count = snap->slot_count;
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    unsigned int *widths = ARENA_ALLOC_S(scratch, slot_count, unsigned int);
+    int *previous = ARENA_ALLOC_S(scratch, slot_count, int);
+    float *distances = ARENA_ALLOC_S(scratch, slot_count, float);
+    Bitset narrow;
+    if (!widths || !previous || !distances ||
+        !bitset_arena_init(&narrow, scratch, MAX(snap->edge_count, 1)) ||
+        !snapshot_widest_tree(snap, start_slot, scratch, widths, previous) ||
+        (end_slot != start_slot && previous[end_slot] == -1)) {
+        mem_arena_release(scratch, mark);
+        return NULL;
+    }
+
+    // 屏蔽比瓶颈窄的边，剩下的边上按延迟求最短路径
+    unsigned int bottleneck = widths[end_slot];
+    for (int e = 0; e < snap->edge_count; e++) {
+        if (snap->bandwidth[e] < bottleneck) {
+            bitset_set(&narrow, e);
+        }
+    }
+    if (!snapshot_dijkstra_masked(snap, start_slot, end_slot, scratch, distances, previous, NULL, &narrow,
+                                  ROUTE_PROFILE_LATENCY, NULL, NULL) ||
+        distances[end_slot] == FLT_MAX) {
+        mem_arena_release(scratch, mark);
+        return NULL;
+    }
+
+    int path_length = 1;
+    for (int current = end_slot; current != start_slot; current = previous[current]) {
+        path_length++;
+    }
+
+    GraphNode **nodes = ARENA_ALLOC_S(scratch, path_length, GraphNode*);
+    EdgeData **edges = ARENA_ALLOC_S(scratch, path_length, EdgeData*);
+    if (!nodes || !edges) {
+        mem_arena_release(scratch, mark);
+        return NULL;
+    }
+
+    // 快照与图版本一致，节点和边一定存在
+    int current = end_slot;
+    for (int i = path_length - 1; i >= 0; i--) {
+        nodes[i] = GraphGetNode(graph, snap->ids[current]);
+        if (i > 0) {
+            edges[i - 1] = GraphGetEdge(graph, snap->ids[previous[current]], snap->ids[current]);
+        }
+        current = previous[current];
+    }
+
+    PathWithEdges *path = path_with_edges_create(nodes, edges, path_length, distances[end_slot]);
+    mem_arena_release(scratch, mark);
+    return path;
+}
+
+PathList* graph_find_k_shortest_paths(Graph *graph, int start_id, int end_id, int max_paths, bool edge_disjoint) {
+    return snapshot_find_k_shortest_paths(GraphGetSnapshot(graph), start_id, end_id, max_paths, edge_disjoint);
+}
+
+Path* graph_find_shortest_path(Graph *graph, int start_id, int end_id) {
+    return snapshot_find_shortest_path(GraphGetSnapshot(graph), start_id, end_id);
+}
+
+Path* graph_find_route(Graph *graph, int start_id, int end_id, RouteProfile profile) {
+    return snapshot_find_route(GraphGetSnapshot(graph), start_id, end_id, profile);
+}
+
 // int main() {
 //     // 创建图（使用之前定义的图结构）
 //     // 添加节点和边（省略具体代码）
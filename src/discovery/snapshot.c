@@ -0,0 +1,509 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file snapshot.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/snapshot.h"
+#include "discovery/metrics.h"
+#include "util/bitset.h"
+
+// 按需扩容，重建时尽量复用已有缓冲区
+static bool SnapshotReserveSlots(GraphSnapshot *snap, int slot_count) {
+    if (snap->offsets && slot_count <= snap->slot_capacity) return true;
+
+    int new_capacity = MAX(MAX(slot_count, 1), snap->slot_capacity * 2);
+    int *ids = (int*)RELLOC_S(snap->ids, new_capacity * sizeof(int));
+    if (!ids) return false;
+    snap->ids = ids;
+
+    int *offsets = (int*)RELLOC_S(snap->offsets, (new_capacity + 1) * sizeof(int));
+    if (!offsets) return false;
+    snap->offsets = offsets;
+
+    snap->slot_capacity = new_capacity;
+    return true;
+}
+
+static bool SnapshotReserveEdges(GraphSnapshot *snap, int edge_count) {
+    if (edge_count <= snap->edge_capacity) return true;
+
+    int new_capacity = MAX(edge_count, snap->edge_capacity * 2);
+    int *targets = (int*)RELLOC_S(snap->targets, new_capacity * sizeof(int));
+    if (!targets) return false;
+    snap->targets = targets;
+
+    float *latency = (float*)RELLOC_S(snap->latency, new_capacity * sizeof(float));
+    if (!latency) return false;
+    snap->latency = latency;
+
+    float *packet_loss = (float*)RELLOC_S(snap->packet_loss, new_capacity * sizeof(float));
+    if (!packet_loss) return false;
+    snap->packet_loss = packet_loss;
+
+    unsigned int *bandwidth = (unsigned int*)RELLOC_S(snap->bandwidth, new_capacity * sizeof(unsigned int));
+    if (!bandwidth) return false;
+    snap->bandwidth = bandwidth;
+
+    snap->edge_capacity = new_capacity;
+    return true;
+}
+
+static bool SnapshotCopyIndex(GraphSnapshot *snap, const GraphIndex *index) {
+    if (!snap->index.entries || snap->index.mask != index->mask) {
+        GraphIndexEntry *entries = (GraphIndexEntry*)RELLOC_S(snap->index.entries,
+                                        (index->mask + 1) * sizeof(GraphIndexEntry));
+        if (!entries) return false;
+        snap->index.entries = entries;
+    }
+
+    memcpy(snap->index.entries, index->entries, (index->mask + 1) * sizeof(GraphIndexEntry));
+    snap->index.mask = index->mask;
+    snap->index.count = index->count;
+    return true;
+}
+
+GraphSnapshot* GraphSnapshotBuild(Graph *graph) {
+    if (!graph) return NULL;
+
+    GraphSnapshot *snap = (GraphSnapshot*)CALLOC_S(1, sizeof(GraphSnapshot));
+    if (!snap) return NULL;
+
+    if (!GraphSnapshotRebuild(snap, graph)) {
+        GraphSnapshotDestroy(snap);
+        return NULL;
+    }
+    return snap;
+}
+
+bool GraphSnapshotRebuild(GraphSnapshot *snap, Graph *graph) {
+    if (!snap || !graph) return false;
+    if (snap->offsets && snap->version == graph->version) return true;
+
+    int edge_count = 0;
+    for (int i = 0; i < graph->slot_count; i++) {
+        if (graph->nodes[i]) {
+            edge_count += graph->nodes[i]->neighbor_count;
+        }
+    }
+
+    if (!SnapshotReserveSlots(snap, graph->slot_count) ||
+        !SnapshotReserveEdges(snap, edge_count) ||
+        !SnapshotCopyIndex(snap, &graph->index)) {
+        return false;
+    }
+
+    // 单次顺序扫描生成 offsets / targets 及 SoA 边权
+    int e = 0;
+    for (int i = 0; i < graph->slot_count; i++) {
+        GraphNode *node = graph->nodes[i];
+        snap->offsets[i] = e;
+        if (!node) {
+            snap->ids[i] = GRAPH_INVALID_ID;
+            continue;
+        }
+
+        snap->ids[i] = node->id;
+        for (int j = 0; j < node->neighbor_count; j++, e++) {
+            const GraphEdge *edge = &node->edges[j];
+            snap->targets[e] = edge->slot;
+            // 已聚合的边使用平滑值，单次抖动不会改变路由
+            snap->latency[e] = GraphEdgeLatency(graph, edge);
+            if (EdgeMetricsReady(graph->metrics, edge->metric)) {
+                snap->packet_loss[e] = graph->metrics->loss[edge->metric];
+                snap->bandwidth[e] = (unsigned int)(graph->metrics->bandwidth[edge->metric] + 0.5f);
+            } else {
+                snap->packet_loss[e] = edge->data.packet_loss;
+                snap->bandwidth[e] = edge->data.bandwidth;
+            }
+        }
+    }
+    snap->offsets[graph->slot_count] = e;
+
+    snap->slot_count = graph->slot_count;
+    snap->edge_count = edge_count;
+    snap->directed = graph->directed;
+    snap->version = graph->version;
+    return true;
+}
+
+/* Transposed copy, edge u -> v becomes v -> u with the same weights; slots and ids are kept */
+GraphSnapshot* GraphSnapshotReverse(const GraphSnapshot *snap) {
+    if (!snap) return NULL;
+
+    GraphSnapshot *reverse = (GraphSnapshot*)CALLOC_S(1, sizeof(GraphSnapshot));
+    if (!reverse) return NULL;
+
+    if (!SnapshotReserveSlots(reverse, snap->slot_count) ||
+        !SnapshotReserveEdges(reverse, snap->edge_count) ||
+        !SnapshotCopyIndex(reverse, &snap->index)) {
+        GraphSnapshotDestroy(reverse);
+        return NULL;
+    }
+
+    // 计数排序：先统计入度，offsets 暂存每行的写入位置
+    memset(reverse->offsets, 0, (snap->slot_count + 1) * sizeof(int));
+    for (int e = 0; e < snap->edge_count; e++) {
+        reverse->offsets[snap->targets[e] + 1]++;
+    }
+    for (int i = 0; i < snap->slot_count; i++) {
+        reverse->offsets[i + 1] += reverse->offsets[i];
+    }
+
+    for (int i = 0; i < snap->slot_count; i++) {
+        for (int e = snap->offsets[i]; e < snap->offsets[i + 1]; e++) {
+            int r = reverse->offsets[snap->targets[e]]++;
+            reverse->targets[r] = i;
+            reverse->latency[r] = snap->latency[e];
+            reverse->packet_loss[r] = snap->packet_loss[e];
+            reverse->bandwidth[r] = snap->bandwidth[e];
+        }
+    }
+
+    // 写入位置已前移一行，整体右移还原
+    memmove(reverse->offsets + 1, reverse->offsets, snap->slot_count * sizeof(int));
+    reverse->offsets[0] = 0;
+    if (snap->slot_count > 0) {
+        memcpy(reverse->ids, snap->ids, snap->slot_count * sizeof(int));
+    }
+
+    reverse->slot_count = snap->slot_count;
+    reverse->edge_count = snap->edge_count;
+    reverse->directed = snap->directed;
+    reverse->version = snap->version;
+    return reverse;
+}
+
+void GraphSnapshotDestroy(GraphSnapshot *snap) {
+    if (!snap) return;
+
+    free(snap->ids);
+    free(snap->offsets);
+    free(snap->targets);
+    free(snap->latency);
+    free(snap->packet_loss);
+    free(snap->bandwidth);
+    free(snap->index.entries);
+    free(snap);
+}
+
+/* Cached snapshot owned by the graph, refreshed when the graph has changed */
+GraphSnapshot* GraphGetSnapshot(Graph *graph) {
+    if (!graph) return NULL;
+
+    if (!graph->snapshot) {
+        graph->snapshot = GraphSnapshotBuild(graph);
+    } else if (!GraphSnapshotRebuild(graph->snapshot, graph)) {
+        return NULL;
+    }
+    return graph->snapshot;
+}
+
+int GraphSnapshotGetSlot(const GraphSnapshot *snap, int node_id) {
+    if (!snap || !snap->index.entries) return GRAPH_INVALID_SLOT;
+
+    return GraphIndexFind(&snap->index, node_id);
+}
+
+// 遍历，访问标记使用按槽位的位图，栈和队列来自线程私有 arena
+void GraphSnapshotDFS(const GraphSnapshot *snap, int start_id, void (*visit)(int node_id)) {
+    int start = GraphSnapshotGetSlot(snap, start_id);
+    if (start == GRAPH_INVALID_SLOT || !visit) return;
+
+    MemArena *scratch = mem_thread_arena();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    Bitset visited;
+    int *stack = ARENA_ALLOC_S(scratch, snap->slot_count, int);
+    int *cursor = ARENA_ALLOC_S(scratch, snap->slot_count, int);
+    if (!bitset_arena_init(&visited, scratch, snap->slot_count) || !stack || !cursor) {
+        mem_arena_release(scratch, mark);
+        return;
+    }
+
+    // 显式栈：每层记录下一个待访问的边
+    int top = 0;
+    stack[top] = start;
+    cursor[top] = snap->offsets[start];
+    bitset_set(&visited, start);
+    visit(snap->ids[start]);
+
+    while (top >= 0) {
+        int slot = stack[top];
+        if (cursor[top] == snap->offsets[slot + 1]) {
+            top--;
+            continue;
+        }
+
+        int next = snap->targets[cursor[top]++];
+        if (bitset_test_and_set(&visited, next)) continue;
+
+        visit(snap->ids[next]);
+        top++;
+        stack[top] = next;
+        cursor[top] = snap->offsets[next];
+    }
+
+    mem_arena_release(scratch, mark);
+}
+
+void GraphSnapshotBFS(const GraphSnapshot *snap, int start_id, void (*visit)(int node_id)) {
+    int start = GraphSnapshotGetSlot(snap, start_id);
+    if (start == GRAPH_INVALID_SLOT || !visit) return;
+
+    MemArena *scratch = mem_thread_arena();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    Bitset visited;
+    int *queue = ARENA_ALLOC_S(scratch, snap->slot_count, int);
+    if (!bitset_arena_init(&visited, scratch, snap->slot_count) || !queue) {
+        mem_arena_release(scratch, mark);
+        return;
+    }
+
+    int head = 0, tail = 0;
+    queue[tail++] = start;
+    bitset_set(&visited, start);
+
+    while (head < tail) {
+        int slot = queue[head++];
+        visit(snap->ids[slot]);
+
+        for (int e = snap->offsets[slot]; e < snap->offsets[slot + 1]; e++) {
+            int next = snap->targets[e];
+            if (!bitset_test_and_set(&visited, next)) {
+                queue[tail++] = next;
+            }
+        }
+    }
+
+    mem_arena_release(scratch, mark);
+}
+
+// 按层同步的并行 BFS
+#define SNAPSHOT_PAR_MIN_FRONTIER 256   /* Smaller levels are expanded by the caller alone */
+
+typedef struct SnapshotBFSShared_ {
+    const GraphSnapshot *snap;
+    const GraphSnapshot *reverse;   /* Optional, also follow in-edges */
+    Bitset visited;
+    int *levels;            /* Optional, hop count per slot */
+    int *labels;            /* Optional, component label per slot */
+    int label;
+    int level;
+    int *frontier;
+    int frontier_count;
+    int *next;
+    int next_count;         /* Appended atomically */
+    int workers;
+    bool ready;             /* Barriers are initialized */
+    bool quit;
+    pthread_barrier_t start;
+    pthread_barrier_t finish;
+} SnapshotBFSShared;
+
+typedef struct SnapshotBFSWorker_ {
+    SnapshotBFSShared *shared;
+    int index;
+} SnapshotBFSWorker;
+
+static void SnapshotBFSExpandRow(SnapshotBFSShared *shared, const GraphSnapshot *snap, int slot) {
+    for (int e = snap->offsets[slot]; e < snap->offsets[slot + 1]; e++) {
+        int next = snap->targets[e];
+        if (bitset_atomic_test_and_set(&shared->visited, next)) continue;
+
+        if (shared->levels) shared->levels[next] = shared->level + 1;
+        if (shared->labels) shared->labels[next] = shared->label;
+        shared->next[__atomic_fetch_add(&shared->next_count, 1, __ATOMIC_RELAXED)] = next;
+    }
+}
+
+static void SnapshotBFSExpand(SnapshotBFSShared *shared, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        SnapshotBFSExpandRow(shared, shared->snap, shared->frontier[i]);
+        if (shared->reverse) SnapshotBFSExpandRow(shared, shared->reverse, shared->frontier[i]);
+    }
+}
+
+static void SnapshotBFSExpandChunk(SnapshotBFSShared *shared, int index) {
+    int count = shared->frontier_count;
+    int begin = (int)((long)count * index / shared->workers);
+    int end = (int)((long)count * (index + 1) / shared->workers);
+    SnapshotBFSExpand(shared, begin, end);
+}
+
+static void* SnapshotBFSWorkerMain(void *arg) {
+    SnapshotBFSWorker *worker = (SnapshotBFSWorker*)arg;
+    SnapshotBFSShared *shared = worker->shared;
+
+    while (!__atomic_load_n(&shared->ready, __ATOMIC_ACQUIRE)) {
+        sched_yield();
+    }
+    while (true) {
+        pthread_barrier_wait(&shared->start);
+        if (shared->quit) break;
+        SnapshotBFSExpandChunk(shared, worker->index);
+        pthread_barrier_wait(&shared->finish);
+    }
+    return NULL;
+}
+
+// 从 start 出发扩展到无新节点为止，返回到达的节点数
+static int SnapshotBFSRun(SnapshotBFSShared *shared, int start) {
+    int reached = 1;
+
+    bitset_atomic_test_and_set(&shared->visited, start);
+    if (shared->levels) shared->levels[start] = 0;
+    if (shared->labels) shared->labels[start] = shared->label;
+    shared->frontier[0] = start;
+    shared->frontier_count = 1;
+    shared->level = 0;
+
+    while (shared->frontier_count > 0) {
+        shared->next_count = 0;
+        if (shared->workers == 1 || shared->frontier_count < SNAPSHOT_PAR_MIN_FRONTIER) {
+            SnapshotBFSExpand(shared, 0, shared->frontier_count);
+        } else {
+            pthread_barrier_wait(&shared->start);
+            SnapshotBFSExpandChunk(shared, 0);
+            pthread_barrier_wait(&shared->finish);
+        }
+
+        SWAP_VAR(int*, shared->frontier, shared->next);
+        shared->frontier_count = shared->next_count;
+        shared->level++;
+        reached += shared->frontier_count;
+    }
+    return reached;
+}
+
+/* Prepare shared state and start threads - 1 workers, the caller is worker 0 */
+static bool SnapshotBFSStart(SnapshotBFSShared *shared, MemArena *scratch, const GraphSnapshot *snap,
+                             int threads, pthread_t *tids, SnapshotBFSWorker *workers) {
+    memset(shared, 0, sizeof(SnapshotBFSShared));
+    shared->snap = snap;
+    shared->frontier = ARENA_ALLOC_S(scratch, snap->slot_count, int);
+    shared->next = ARENA_ALLOC_S(scratch, snap->slot_count, int);
+    if (!bitset_arena_init(&shared->visited, scratch, snap->slot_count) ||
+        !shared->frontier || !shared->next) {
+        return false;
+    }
+
+    // 线程创建失败时按实际创建的数量初始化屏障
+    int created = 1;
+    while (created < threads) {
+        workers[created].shared = shared;
+        workers[created].index = created;
+        if (pthread_create(&tids[created], NULL, SnapshotBFSWorkerMain, &workers[created]) != 0) break;
+        created++;
+    }
+
+    shared->workers = created;
+    if (created > 1) {
+        pthread_barrier_init(&shared->start, NULL, created);
+        pthread_barrier_init(&shared->finish, NULL, created);
+    }
+    __atomic_store_n(&shared->ready, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+static void SnapshotBFSStop(SnapshotBFSShared *shared, pthread_t *tids) {
+    if (shared->workers == 1) return;
+
+    shared->quit = true;
+    pthread_barrier_wait(&shared->start);
+    for (int i = 1; i < shared->workers; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    pthread_barrier_destroy(&shared->start);
+    pthread_barrier_destroy(&shared->finish);
+}
+
+/*
+ * Level-synchronous BFS split across threads. levels (optional, slot_count
+ * entries) receives the hop count of every reached slot, unreached slots are
+ * left untouched. Returns the number of reached nodes.
+ */
+int GraphSnapshotParallelBFS(const GraphSnapshot *snap, int start_id, int threads, int *levels) {
+    int start = GraphSnapshotGetSlot(snap, start_id);
+    if (start == GRAPH_INVALID_SLOT) return 0;
+
+    threads = MAX(1, MIN(threads, SNAPSHOT_MAX_THREADS));
+    pthread_t tids[SNAPSHOT_MAX_THREADS];
+    SnapshotBFSWorker workers[SNAPSHOT_MAX_THREADS];
+    SnapshotBFSShared shared;
+
+    MemArena *scratch = mem_thread_arena();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    if (!SnapshotBFSStart(&shared, scratch, snap, threads, tids, workers)) {
+        mem_arena_release(scratch, mark);
+        return 0;
+    }
+
+    shared.levels = levels;
+    int reached = SnapshotBFSRun(&shared, start);
+
+    SnapshotBFSStop(&shared, tids);
+    mem_arena_release(scratch, mark);
+    return reached;
+}
+
+/*
+ * Label the connected segments of a snapshot. component receives the label
+ * per slot, -1 for free slots. Directed snapshots are labelled by weakly
+ * connected segment, following edges both ways. Returns the number of
+ * segments.
+ */
+int GraphSnapshotComponents(const GraphSnapshot *snap, int threads, int *component) {
+    if (!snap || !component) return 0;
+
+    // 有向图只沿出边扩展时标号取决于遍历顺序，需同时沿入边扩展
+    GraphSnapshot *reverse = NULL;
+    if (snap->directed && !(reverse = GraphSnapshotReverse(snap))) return 0;
+
+    threads = MAX(1, MIN(threads, SNAPSHOT_MAX_THREADS));
+    pthread_t tids[SNAPSHOT_MAX_THREADS];
+    SnapshotBFSWorker workers[SNAPSHOT_MAX_THREADS];
+    SnapshotBFSShared shared;
+
+    MemArena *scratch = mem_thread_arena();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    if (!SnapshotBFSStart(&shared, scratch, snap, threads, tids, workers)) {
+        mem_arena_release(scratch, mark);
+        if (reverse) GraphSnapshotDestroy(reverse);
+        return 0;
+    }
+
+    shared.reverse = reverse;
+    shared.labels = component;
+    int count = 0;
+    for (int slot = 0; slot < snap->slot_count; slot++) {
+        if (snap->ids[slot] == GRAPH_INVALID_ID) {
+            component[slot] = -1;
+        } else if (!bitset_test(&shared.visited, slot)) {
+            shared.label = count++;
+            SnapshotBFSRun(&shared, slot);
+        }
+    }
+
+    SnapshotBFSStop(&shared, tids);
+    mem_arena_release(scratch, mark);
+    if (reverse) GraphSnapshotDestroy(reverse);
+    return count;
+}
@@ -0,0 +1,327 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file sptree.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/sptree.h"
+#include "discovery/metrics.h"
+#include "util/bitset.h"
+#include "util/heap.h"
+
+static const GraphEdge* sptree_find_edge(const GraphNode *from, int to_slot) {
+    for (int i = 0; i < from->neighbor_count; i++) {
+        if (from->edges[i].slot == to_slot) {
+            return &from->edges[i];
+        }
+    }
+    return NULL;
+}
+
+static void sptree_reset_slot(ShortestPathTree *tree, int slot) {
+    tree->distances[slot] = FLT_MAX;
+    tree->parents[slot] = -1;
+    tree->parent_cost[slot] = 0;
+}
+
+// 数组随图的槽位增长，新槽位不可达
+static bool sptree_reserve(ShortestPathTree *tree, int slot_count) {
+    if (slot_count <= tree->capacity) return true;
+
+    int capacity = MAX(slot_count, tree->capacity * 2);
+    float *distances = (float*)RELLOC_S(tree->distances, capacity * sizeof(float));
+    if (!distances) return false;
+    tree->distances = distances;
+
+    int *parents = (int*)RELLOC_S(tree->parents, capacity * sizeof(int));
+    if (!parents) return false;
+    tree->parents = parents;
+
+    float *parent_cost = (float*)RELLOC_S(tree->parent_cost, capacity * sizeof(float));
+    if (!parent_cost) return false;
+    tree->parent_cost = parent_cost;
+
+    for (int i = tree->capacity; i < capacity; i++) {
+        sptree_reset_slot(tree, i);
+    }
+    tree->capacity = capacity;
+    return true;
+}
+
+// 从已入堆的节点向外松弛，与完整 Dijkstra 相同，但只访问距离变化的节点
+static void sptree_propagate(ShortestPathTree *tree, Graph *graph, IndexedHeap *heap) {
+    while (!heap_empty(heap)) {
+        float distance;
+        int current = heap_pop(heap, &distance);
+        const GraphNode *node = graph->nodes[current];
+        tree->stats.touched++;
+
+        for (int i = 0; i < node->neighbor_count; i++) {
+            const GraphEdge *edge = &node->edges[i];
+            float cost = GraphEdgeLatency(graph, edge);
+            float alt = distance + cost;
+            if (alt < tree->distances[edge->slot] && !heap_popped(heap, edge->slot)) {
+                tree->distances[edge->slot] = alt;
+                tree->parents[edge->slot] = current;
+                tree->parent_cost[edge->slot] = cost;
+                heap_push_or_decrease(heap, edge->slot, alt);
+            }
+        }
+    }
+}
+
+bool sptree_recompute(ShortestPathTree *tree, Graph *graph) {
+    if (!sptree_reserve(tree, graph->slot_count)) return false;
+
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    IndexedHeap heap;
+    if (!heap_arena_init(&heap, scratch, graph->slot_count)) {
+        mem_arena_release(scratch, mark);
+        return false;
+    }
+
+    for (int i = 0; i < tree->capacity; i++) {
+        sptree_reset_slot(tree, i);
+    }
+
+    int source = GraphGetSlot(graph, tree->source_id);
+    if (source != GRAPH_INVALID_SLOT) {
+        tree->distances[source] = 0;
+        heap_push_or_decrease(&heap, source, 0);
+        sptree_propagate(tree, graph, &heap);
+    }
+
+    mem_arena_release(scratch, mark);
+    tree->version = graph->version;
+    tree->stats.recomputes++;
+    return true;
+}
+
+ShortestPathTree* sptree_create(Graph *graph, int source_id) {
+    if (!graph) return NULL;
+
+    ShortestPathTree *tree = (ShortestPathTree*)CALLOC_S(1, sizeof(ShortestPathTree));
+    if (!tree) return NULL;
+
+    tree->source_id = source_id;
+    if (!sptree_recompute(tree, graph)) {
+        sptree_destroy(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+void sptree_destroy(ShortestPathTree *tree) {
+    if (!tree) return;
+
+    FREE_S(tree->distances);
+    FREE_S(tree->parents);
+    FREE_S(tree->parent_cost);
+    FREE_S(tree);
+}
+
+// 最优入边：只考虑不在受影响子树中的前驱
+static void sptree_reattach(ShortestPathTree *tree, Graph *graph, int slot, const Bitset *affected) {
+    const GraphNode *node = graph->nodes[slot];
+    // 无向图的入边即出边的镜像，有向图使用反向邻接表
+    int count = graph->directed ? node->in_count : node->neighbor_count;
+    for (int i = 0; i < count; i++) {
+        int from = graph->directed ? node->in_slots[i] : node->edges[i].slot;
+        if (bitset_test(affected, from) || tree->distances[from] == FLT_MAX) continue;
+
+        const GraphEdge *edge = sptree_find_edge(graph->nodes[from], slot);
+        if (!edge) continue;
+
+        float cost = GraphEdgeLatency(graph, edge);
+        if (tree->distances[from] + cost < tree->distances[slot]) {
+            tree->distances[slot] = tree->distances[from] + cost;
+            tree->parents[slot] = from;
+            tree->parent_cost[slot] = cost;
+        }
+    }
+}
+
+// 树边变贵或被删除：摘下 head 为根的子树，经剩余入边重新挂接后向外松弛
+static bool sptree_repair_subtree(ShortestPathTree *tree, Graph *graph, int head, MemArena *scratch) {
+    Bitset affected;
+    int *members = ARENA_ALLOC_S(scratch, graph->slot_count, int);
+    if (!bitset_arena_init(&affected, scratch, graph->slot_count) || !members) return false;
+
+    int count = 0;
+    int limit = MAX(graph->slot_count / SPTREE_MAX_AFFECTED, 1);
+    members[count++] = head;
+    bitset_set(&affected, head);
+    for (int i = 0; i < count; i++) {
+        const GraphNode *node = graph->nodes[members[i]];
+        for (int j = 0; j < node->neighbor_count; j++) {
+            int child = node->edges[j].slot;
+            if (tree->parents[child] == members[i] && !bitset_test_and_set(&affected, child)) {
+                if (count >= limit) return false;
+                members[count++] = child;
+            }
+        }
+    }
+
+    IndexedHeap heap;
+    if (!heap_arena_init(&heap, scratch, graph->slot_count)) return false;
+
+    for (int i = 0; i < count; i++) {
+        sptree_reset_slot(tree, members[i]);
+    }
+    for (int i = 0; i < count; i++) {
+        sptree_reattach(tree, graph, members[i], &affected);
+        if (tree->distances[members[i]] != FLT_MAX) {
+            heap_push_or_decrease(&heap, members[i], tree->distances[members[i]]);
+        }
+    }
+    sptree_propagate(tree, graph, &heap);
+    return true;
+}
+
+// 单向边 from -> to 的权重变化，返回 false 时需要完整重算
+static bool sptree_repair_edge(ShortestPathTree *tree, Graph *graph, int from, int to, MemArena *scratch) {
+    const GraphEdge *edge = sptree_find_edge(graph->nodes[from], to);
+    float cost = edge ? GraphEdgeLatency(graph, edge) : FLT_MAX;
+
+    if (tree->parents[to] == from) {
+        if (cost == tree->parent_cost[to]) return true;
+        if (cost > tree->parent_cost[to]) return sptree_repair_subtree(tree, graph, to, scratch);
+    } else if (!edge || tree->distances[from] == FLT_MAX || tree->distances[from] + cost >= tree->distances[to]) {
+        // 非树边变贵或仍不更短，树不变
+        return true;
+    }
+
+    // 变便宜：从 to 开始向外松弛
+    IndexedHeap heap;
+    if (!heap_arena_init(&heap, scratch, graph->slot_count)) return false;
+
+    tree->distances[to] = tree->distances[from] + cost;
+    tree->parents[to] = from;
+    tree->parent_cost[to] = cost;
+    heap_push_or_decrease(&heap, to, tree->distances[to]);
+    sptree_propagate(tree, graph, &heap);
+    return true;
+}
+
+static bool sptree_apply(ShortestPathTree *tree, Graph *graph, const GraphDelta *delta, MemArena *scratch) {
+    switch (delta->type) {
+        case GRAPH_DELTA_NODE_ADD: {
+            if (delta->from_id == tree->source_id) return false;
+            int slot = GraphGetSlot(graph, delta->from_id);
+            if (slot != GRAPH_INVALID_SLOT) {
+                sptree_reset_slot(tree, slot);
+            }
+            return true;
+        }
+        case GRAPH_DELTA_NODE_UPDATE:
+            return true;
+        case GRAPH_DELTA_NODE_REMOVE:
+            // 槽位已释放，无法找到原有子树
+            return false;
+        default: {
+            int from = GraphGetSlot(graph, delta->from_id);
+            int to = GraphGetSlot(graph, delta->to_id);
+            // 端点随后被删除，由其删除记录触发重算
+            if (from == GRAPH_INVALID_SLOT || to == GRAPH_INVALID_SLOT) return true;
+
+            if (!sptree_repair_edge(tree, graph, from, to, scratch)) return false;
+            return graph->directed || from == to || sptree_repair_edge(tree, graph, to, from, scratch);
+        }
+    }
+}
+
+/*
+ * Bring the tree up to graph->version, repairing from the journal when
+ * possible. Returns false only when memory ran out.
+ */
+bool sptree_sync(ShortestPathTree *tree, Graph *graph) {
+    if (!tree || !graph) return false;
+    if (tree->version == graph->version) return true;
+    if (!graph->journal || !sptree_reserve(tree, graph->slot_count)) return sptree_recompute(tree, graph);
+
+    unsigned long seq = GraphJournalSeek(graph->journal, tree->version);
+    if (seq == GRAPH_JOURNAL_GAP) return sptree_recompute(tree, graph);
+
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    GraphDelta *deltas = ARENA_ALLOC_S(scratch, SPTREE_MAX_DELTAS, GraphDelta);
+    int count = deltas ? GraphJournalRead(graph->journal, &seq, deltas, SPTREE_MAX_DELTAS) : -1;
+
+    // 每个版本都要有日志记录，否则存在未记录的权重变化
+    // 读满时同一批次可能还有未读的记录，改为全量重算
+    unsigned long seen = tree->version;
+    bool repaired = count >= 0 && count < SPTREE_MAX_DELTAS;
+    for (int i = 0; repaired && i < count; i++) {
+        repaired = deltas[i].version == seen || deltas[i].version == seen + 1;
+        seen = deltas[i].version;
+    }
+    repaired = repaired && seen == graph->version;
+
+    for (int i = 0; repaired && i < count; i++) {
+        MemArenaMark round = mem_arena_mark(scratch);
+        repaired = sptree_apply(tree, graph, &deltas[i], scratch);
+        mem_arena_release(scratch, round);
+    }
+    mem_arena_release(scratch, mark);
+
+    if (!repaired) return sptree_recompute(tree, graph);
+
+    tree->version = graph->version;
+    tree->stats.repairs++;
+    return true;
+}
+
+float sptree_distance(const ShortestPathTree *tree, Graph *graph, int node_id) {
+    int slot = GraphGetSlot(graph, node_id);
+    if (!tree || slot == GRAPH_INVALID_SLOT || slot >= tree->capacity) return FLT_MAX;
+
+    return tree->distances[slot];
+}
+
+/* Path from the source to node_id, O(hops). The tree must be in sync */
+Path* sptree_path(const ShortestPathTree *tree, Graph *graph, int node_id) {
+    if (sptree_distance(tree, graph, node_id) == FLT_MAX) return NULL;
+
+    int slot = GraphGetSlot(graph, node_id);
+    int length = 1;
+    for (int current = slot; tree->parents[current] >= 0; current = tree->parents[current]) {
+        length++;
+    }
+
+    MemArena *scratch = router_scratch();
+    MemArenaMark mark = mem_arena_mark(scratch);
+    int *ids = ARENA_ALLOC_S(scratch, length, int);
+    if (!ids) {
+        mem_arena_release(scratch, mark);
+        return NULL;
+    }
+
+    int current = slot;
+    for (int i = length - 1; i >= 0; i--) {
+        ids[i] = graph->nodes[current]->id;
+        current = tree->parents[current];
+    }
+
+    Path *path = path_create(ids, length, tree->distances[slot]);
+    mem_arena_release(scratch, mark);
+    return path;
+}
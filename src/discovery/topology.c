@@ -0,0 +1,483 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file topology.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/topology.h"
+
+/* Global */
+
+Graph* g_dev_topology = NULL;
+GraphNode* g_cur_dev = NULL;
+
+/* Retired snapshot waiting for readers to drain */
+typedef struct TopologyRetired_ {
+    GraphSnapshot *snap;
+    NextHopTable *table;   /* Retired next-hop table instead of a snapshot */
+    LandmarkTable *landmarks;
+    unsigned long epoch;
+} TopologyRetired;
+
+static GraphSnapshot *g_topology_view = NULL;      /* Published, read atomically */
+static NextHopTable *g_next_hop_table = NULL;      /* Published, read atomically, may lag the view */
+static LandmarkTable *g_landmarks = NULL;          /* Published with the next-hop table */
+static unsigned long g_topology_epoch = 1;
+static TopologyReader g_topology_readers[TOPOLOGY_MAX_READERS];
+static __thread TopologyReader *t_topology_reader = NULL;
+static pthread_key_t g_topology_reader_key;
+static pthread_once_t g_topology_reader_once = PTHREAD_ONCE_INIT;
+static bool g_topology_reader_keyed = false;        /* Slots are released on thread exit */
+
+// 以下仅在持有写锁时访问
+static pthread_mutex_t g_topology_write_lock = PTHREAD_MUTEX_INITIALIZER;
+static TopologyRetired *g_retired = NULL;
+static int g_retired_count = 0;
+static int g_retired_capacity = 0;
+static GraphSnapshot *g_spare_view = NULL;         /* Reclaimed buffers for the next publish */
+static GraphExpiry *g_topology_expiry = NULL;
+
+// 后台路由线程，新快照发布后重建下一跳表与地标表
+static pthread_mutex_t g_routing_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_routing_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t g_routing_thread;
+static bool g_routing_running = false;
+static bool g_routing_pending = false;
+static int g_routing_threads = 1;
+
+// 读者
+// 线程退出时由 key 的析构函数归还槽位，未显式注销的线程不会永久占用
+static void topology_reader_release(void *arg) {
+    TopologyReader *reader = (TopologyReader*)arg;
+
+    __atomic_store_n(&reader->depth, 0, __ATOMIC_RELEASE);
+    __atomic_clear(&reader->in_use, __ATOMIC_RELEASE);
+}
+
+static void topology_reader_key_init(void) {
+    g_topology_reader_keyed = pthread_key_create(&g_topology_reader_key, topology_reader_release) == 0;
+}
+
+static TopologyReader* topology_reader_acquire(void) {
+    if (t_topology_reader) return t_topology_reader;
+
+    pthread_once(&g_topology_reader_once, topology_reader_key_init);
+    while (true) {
+        for (int i = 0; i < TOPOLOGY_MAX_READERS; i++) {
+            TopologyReader *reader = &g_topology_readers[i];
+            if (!__atomic_test_and_set(&reader->in_use, __ATOMIC_ACQUIRE)) {
+                t_topology_reader = reader;
+                if (g_topology_reader_keyed) {
+                    pthread_setspecific(g_topology_reader_key, reader);
+                }
+                return reader;
+            }
+        }
+        // 超过 TOPOLOGY_MAX_READERS 个线程同时读取时等待槽位归还
+        sched_yield();
+    }
+}
+
+void topology_reader_unregister(void) {
+    TopologyReader *reader = t_topology_reader;
+    if (!reader) return;
+
+    BUG(reader->depth != 0);
+    t_topology_reader = NULL;
+    if (g_topology_reader_keyed) {
+        pthread_setspecific(g_topology_reader_key, NULL);
+    }
+    __atomic_clear(&reader->in_use, __ATOMIC_RELEASE);
+}
+
+const GraphSnapshot* topology_read_begin(void) {
+    TopologyReader *reader = topology_reader_acquire();
+
+    if (reader->depth > 0) {
+        __atomic_store_n(&reader->depth, reader->depth + 1, __ATOMIC_RELAXED);
+    } else {
+        // 先登记纪元并标记活跃，再读取发布指针；顺序由 seq_cst 保证
+        __atomic_store_n(&reader->epoch, __atomic_load_n(&g_topology_epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+        __atomic_store_n(&reader->depth, 1, __ATOMIC_SEQ_CST);
+    }
+    return __atomic_load_n(&g_topology_view, __ATOMIC_SEQ_CST);
+}
+
+void topology_read_end(void) {
+    TopologyReader *reader = t_topology_reader;
+    BUG(!reader || reader->depth <= 0);
+
+    __atomic_store_n(&reader->depth, reader->depth - 1, __ATOMIC_RELEASE);
+}
+
+// 回收
+static void topology_recycle(GraphSnapshot *snap) {
+    if (!g_spare_view) {
+        g_spare_view = snap;
+    } else {
+        GraphSnapshotDestroy(snap);
+    }
+}
+
+static void topology_retired_free(const TopologyRetired *retired) {
+    if (retired->table || retired->landmarks) {
+        next_hop_table_destroy(retired->table);
+        landmark_table_destroy(retired->landmarks);
+    } else {
+        topology_recycle(retired->snap);
+    }
+}
+
+static unsigned long topology_min_active_epoch(void) {
+    unsigned long min_epoch = ULONG_MAX;
+    for (int i = 0; i < TOPOLOGY_MAX_READERS; i++) {
+        TopologyReader *reader = &g_topology_readers[i];
+        if (__atomic_load_n(&reader->depth, __ATOMIC_SEQ_CST) > 0) {
+            unsigned long epoch = __atomic_load_n(&reader->epoch, __ATOMIC_SEQ_CST);
+            min_epoch = MIN(min_epoch, epoch);
+        }
+    }
+    return min_epoch;
+}
+
+static void topology_reclaim(void) {
+    unsigned long min_epoch = topology_min_active_epoch();
+
+    // 所有活跃读者都在退休之后进入时，旧快照已不可见
+    int kept = 0;
+    for (int i = 0; i < g_retired_count; i++) {
+        if (g_retired[i].epoch < min_epoch) {
+            topology_retired_free(&g_retired[i]);
+        } else {
+            g_retired[kept++] = g_retired[i];
+        }
+    }
+    g_retired_count = kept;
+}
+
+static bool topology_retire(const TopologyRetired *retired) {
+    if (g_retired_count >= g_retired_capacity) {
+        int new_capacity = g_retired_capacity ? g_retired_capacity * 2 : 8;
+        TopologyRetired *retired = (TopologyRetired*)RELLOC_S(g_retired, new_capacity * sizeof(TopologyRetired));
+        if (!retired) return false;
+
+        g_retired = retired;
+        g_retired_capacity = new_capacity;
+    }
+    g_retired[g_retired_count++] = *retired;
+    return true;
+}
+
+// 无法登记时同步等待可能看到旧对象的读者退出
+static void topology_retire_sync(const TopologyRetired *retired) {
+    if (topology_retire(retired)) return;
+
+    while (topology_min_active_epoch() <= retired->epoch) {
+        sched_yield();
+    }
+    topology_retired_free(retired);
+}
+
+static void topology_routing_kick(void) {
+    pthread_mutex_lock(&g_routing_lock);
+    g_routing_pending = true;
+    pthread_cond_signal(&g_routing_cond);
+    pthread_mutex_unlock(&g_routing_lock);
+}
+
+// 写者
+static void topology_publish(void) {
+    GraphSnapshot *current = g_topology_view;
+    if (current && current->version == g_dev_topology->version) return;
+
+    GraphSnapshot *next = g_spare_view;
+    g_spare_view = NULL;
+    if (next) {
+        if (!GraphSnapshotRebuild(next, g_dev_topology)) {
+            GraphSnapshotDestroy(next);
+            return;
+        }
+    } else {
+        next = GraphSnapshotBuild(g_dev_topology);
+        if (!next) return;
+    }
+
+    GraphSnapshot *old = __atomic_exchange_n(&g_topology_view, next, __ATOMIC_SEQ_CST);
+    unsigned long epoch = __atomic_fetch_add(&g_topology_epoch, 1, __ATOMIC_SEQ_CST);
+
+    if (old) {
+        TopologyRetired retired = { old, NULL, NULL, epoch };
+        topology_retire_sync(&retired);
+    }
+    topology_reclaim();
+    topology_routing_kick();
+}
+
+Graph* topology_write_begin(void) {
+    pthread_mutex_lock(&g_topology_write_lock);
+    return g_dev_topology;
+}
+
+void topology_write_end(void) {
+    if (g_dev_topology) {
+        topology_publish();
+    }
+    pthread_mutex_unlock(&g_topology_write_lock);
+}
+
+/* Wait until every retired snapshot has been reclaimed */
+void topology_synchronize(void) {
+    pthread_mutex_lock(&g_topology_write_lock);
+    topology_reclaim();
+    while (g_retired_count > 0) {
+        pthread_mutex_unlock(&g_topology_write_lock);
+        sched_yield();
+        pthread_mutex_lock(&g_topology_write_lock);
+        topology_reclaim();
+    }
+    pthread_mutex_unlock(&g_topology_write_lock);
+}
+
+static bool topology_expiry_init(void) {
+    if (!g_topology_expiry) {
+        g_topology_expiry = GraphExpiryCreate(g_dev_topology, TOPOLOGY_NODE_TIMEOUT_MS, TOPOLOGY_EDGE_TIMEOUT_MS,
+                                              timer_monotonic_ms());
+    }
+    return g_topology_expiry != NULL;
+}
+
+bool topology_init(bool directed) {
+    pthread_mutex_lock(&g_topology_write_lock);
+    if (!g_dev_topology) {
+        g_dev_topology = GraphCreate(directed);
+    }
+    bool ok = g_dev_topology != NULL && GraphEnableJournal(g_dev_topology, TOPOLOGY_JOURNAL_CAPACITY) &&
+              topology_expiry_init();
+    if (ok) {
+        topology_publish();
+    }
+    pthread_mutex_unlock(&g_topology_write_lock);
+    return ok;
+}
+
+/*
+ * Start from a saved image instead of an empty graph so routing works before
+ * discovery has finished. Call instead of topology_init, before any reader.
+ */
+bool topology_restore(const char *path) {
+    GraphImage *image = GraphImageOpen(path);
+    if (!image) return false;
+
+    Graph *graph = GraphImageRestore(image);
+    GraphImageClose(image);
+    if (!graph || !GraphEnableJournal(graph, TOPOLOGY_JOURNAL_CAPACITY)) {
+        GraphDestroy(graph);
+        return false;
+    }
+
+    pthread_mutex_lock(&g_topology_write_lock);
+    bool ok = g_dev_topology == NULL;
+    if (ok) {
+        g_dev_topology = graph;
+        // 恢复的节点与边需要重新收到心跳，否则到期删除
+        ok = topology_expiry_init();
+        if (ok) {
+            topology_publish();
+        } else {
+            g_dev_topology = NULL;
+        }
+    }
+    pthread_mutex_unlock(&g_topology_write_lock);
+
+    if (!ok) {
+        GraphDestroy(graph);
+    }
+    return ok;
+}
+
+void topology_destroy(void) {
+    topology_routing_stop();
+    topology_synchronize();
+
+    pthread_mutex_lock(&g_topology_write_lock);
+    GraphSnapshotDestroy(__atomic_exchange_n(&g_topology_view, NULL, __ATOMIC_SEQ_CST));
+    GraphSnapshotDestroy(g_spare_view);
+    g_spare_view = NULL;
+    next_hop_table_destroy(__atomic_exchange_n(&g_next_hop_table, NULL, __ATOMIC_SEQ_CST));
+    landmark_table_destroy(__atomic_exchange_n(&g_landmarks, NULL, __ATOMIC_SEQ_CST));
+    FREE_S(g_retired);
+    g_retired_count = g_retired_capacity = 0;
+    GraphExpiryDestroy(g_topology_expiry);
+    g_topology_expiry = NULL;
+
+    GraphDestroy(g_dev_topology);
+    g_dev_topology = NULL;
+    g_cur_dev = NULL;
+    pthread_mutex_unlock(&g_topology_write_lock);
+}
+
+/* Change log of g_dev_topology, readable without the write lock */
+const GraphJournal* topology_journal(void) {
+    return g_dev_topology ? g_dev_topology->journal : NULL;
+}
+
+/* Snapshot the topology to disk, the write and fsync happen in the background */
+bool topology_save(const char *path) {
+    pthread_mutex_lock(&g_topology_write_lock);
+    bool ok = g_dev_topology && GraphImageSaveAsync(g_dev_topology, path);
+    pthread_mutex_unlock(&g_topology_write_lock);
+    return ok;
+}
+
+/*
+ * Timers of g_dev_topology. Heartbeats re-arm node and edge timers here, and
+ * discovery arms its status timeouts on the same wheel; only between
+ * topology_write_begin and topology_write_end.
+ */
+GraphExpiry* topology_expiry(void) {
+    return g_topology_expiry;
+}
+
+/* Run due timers and publish the departures, call periodically */
+int topology_expire(void) {
+    Graph *graph = topology_write_begin();
+    int removed = graph ? GraphExpiryAdvance(g_topology_expiry, timer_monotonic_ms()) : 0;
+    topology_write_end();
+    return removed;
+}
+
+// 路由：在读临界区内基于已发布快照构建，构建期间不持有写锁
+static void topology_routing_rebuild(void) {
+    const GraphSnapshot *snap = topology_read_begin();
+    NextHopTable *current = __atomic_load_n(&g_next_hop_table, __ATOMIC_SEQ_CST);
+    NextHopTable *table = NULL;
+    LandmarkTable *landmarks = NULL;
+    if (snap && (!current || current->version != snap->version)) {
+        table = next_hop_table_build(snap, g_routing_threads);
+        landmarks = landmark_table_build(snap, LANDMARK_DEFAULT_COUNT);
+    }
+    topology_read_end();
+    if (!table || !landmarks) {
+        next_hop_table_destroy(table);
+        landmark_table_destroy(landmarks);
+        return;
+    }
+
+    pthread_mutex_lock(&g_topology_write_lock);
+    NextHopTable *old = __atomic_exchange_n(&g_next_hop_table, table, __ATOMIC_SEQ_CST);
+    LandmarkTable *old_landmarks = __atomic_exchange_n(&g_landmarks, landmarks, __ATOMIC_SEQ_CST);
+    unsigned long epoch = __atomic_fetch_add(&g_topology_epoch, 1, __ATOMIC_SEQ_CST);
+    if (old || old_landmarks) {
+        TopologyRetired retired = { NULL, old, old_landmarks, epoch };
+        topology_retire_sync(&retired);
+    }
+    topology_reclaim();
+    pthread_mutex_unlock(&g_topology_write_lock);
+}
+
+static void* topology_routing_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_routing_lock);
+    while (true) {
+        while (g_routing_running && !g_routing_pending) {
+            pthread_cond_wait(&g_routing_cond, &g_routing_lock);
+        }
+        if (!g_routing_running) break;
+
+        // 多次发布合并为一次重建
+        g_routing_pending = false;
+        pthread_mutex_unlock(&g_routing_lock);
+        topology_routing_rebuild();
+        pthread_mutex_lock(&g_routing_lock);
+    }
+    pthread_mutex_unlock(&g_routing_lock);
+
+    topology_reader_unregister();
+    mem_thread_arena_destroy();
+    return NULL;
+}
+
+/* Keep a next-hop table and landmark table for the published topology, rebuilt by threads workers */
+bool topology_routing_start(int threads) {
+    pthread_mutex_lock(&g_routing_lock);
+    bool ok = true;
+    if (!g_routing_running) {
+        g_routing_threads = MAX(1, threads);
+        g_routing_running = true;
+        g_routing_pending = true;
+        if (pthread_create(&g_routing_thread, NULL, topology_routing_main, NULL) != 0) {
+            g_routing_running = false;
+            ok = false;
+        }
+    }
+    pthread_mutex_unlock(&g_routing_lock);
+    return ok;
+}
+
+void topology_routing_stop(void) {
+    pthread_mutex_lock(&g_routing_lock);
+    bool running = g_routing_running;
+    g_routing_running = false;
+    pthread_cond_signal(&g_routing_cond);
+    pthread_mutex_unlock(&g_routing_lock);
+
+    if (running) {
+        pthread_join(g_routing_thread, NULL);
+    }
+}
+
+/*
+ * Next hop from src_id towards dst_id for the forwarding plane, never blocks.
+ * GRAPH_INVALID_ID when unreachable or not known to the newest table yet.
+ */
+int topology_next_hop(int src_id, int dst_id) {
+    topology_read_begin();
+    const NextHopTable *table = __atomic_load_n(&g_next_hop_table, __ATOMIC_SEQ_CST);
+    int hop = table ? next_hop_lookup(table, src_id, dst_id) : GRAPH_INVALID_ID;
+    topology_read_end();
+    return hop;
+}
+
+/*
+ * Point-to-point shortest path on the published topology, never blocks.
+ * Uses the landmark bounds when they match the view, bidirectional search
+ * while the routing thread is still catching up.
+ */
+Path* topology_find_shortest_path(int src_id, int dst_id) {
+    const GraphSnapshot *snap = topology_read_begin();
+    const LandmarkTable *landmarks = __atomic_load_n(&g_landmarks, __ATOMIC_SEQ_CST);
+    Path *path = NULL;
+    if (snap && landmarks && landmarks->version == snap->version) {
+        path = snapshot_find_path_alt(snap, landmarks, src_id, dst_id, NULL);
+    } else if (snap) {
+        path = snapshot_find_path_bidirectional(snap, NULL, src_id, dst_id, NULL);
+    }
+    topology_read_end();
+    return path;
+}
+
+/* Routes from src_id to every peer on the published topology, free with route_tree_destroy */
+RouteTree* topology_route_tree(int src_id, RouteProfile profile) {
+    const GraphSnapshot *snap = topology_read_begin();
+    RouteTree *tree = snapshot_route_tree(snap, src_id, profile);
+    topology_read_end();
+    return tree;
+}
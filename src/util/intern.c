@@ -0,0 +1,190 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file intern.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "util/intern.h"
+
+#define STR_INTERN_PAGE_SIZE (1U << STR_INTERN_PAGE_BITS)
+
+/* Stored string, the text follows the header */
+typedef struct StrEntry_ {
+    uint32_t hash;
+    uint32_t len;
+    char text[];
+} StrEntry;
+
+/* Hash -> id index, open addressing */
+typedef struct StrSlot_ {
+    uint32_t hash;
+    StrId id;                   /* STR_ID_NONE when empty */
+} StrSlot;
+
+static pthread_mutex_t g_intern_lock = PTHREAD_MUTEX_INITIALIZER;
+static MemArena g_intern_arena;
+static StrEntry **g_intern_pages[STR_INTERN_MAX_PAGES];  /* Id -> entry, pages never move */
+static uint32_t g_intern_count = 1;                      /* Published with release */
+static StrSlot *g_intern_index = NULL;
+static uint32_t g_intern_mask = 0;
+static size_t g_intern_bytes = 0;
+static size_t g_intern_lookups = 0;
+
+static uint32_t str_hash(const char *str, size_t len) {
+    uint32_t h = 2166136261U;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (uint8_t)str[i]) * 16777619U;
+    }
+    return h;
+}
+
+static inline StrEntry* str_entry(StrId id) {
+    return g_intern_pages[id >> STR_INTERN_PAGE_BITS][id & (STR_INTERN_PAGE_SIZE - 1)];
+}
+
+// 以下在持有锁时调用
+static bool str_index_grow(void) {
+    uint32_t capacity = g_intern_mask ? (g_intern_mask + 1) * 2 : 1024;
+    StrSlot *index = (StrSlot*)CALLOC_S(capacity, sizeof(StrSlot));
+    if (!index) return false;
+
+    for (uint32_t i = 0; g_intern_index && i <= g_intern_mask; i++) {
+        if (g_intern_index[i].id == STR_ID_NONE) continue;
+
+        uint32_t pos = g_intern_index[i].hash & (capacity - 1);
+        while (index[pos].id != STR_ID_NONE) {
+            pos = (pos + 1) & (capacity - 1);
+        }
+        index[pos] = g_intern_index[i];
+    }
+    free(g_intern_index);
+    g_intern_index = index;
+    g_intern_mask = capacity - 1;
+    return true;
+}
+
+static StrId str_insert(const char *str, size_t len, uint32_t hash, uint32_t pos) {
+    StrId id = g_intern_count;
+    uint32_t page = id >> STR_INTERN_PAGE_BITS;
+    if (page >= STR_INTERN_MAX_PAGES || len > UINT32_MAX) return STR_ID_NONE;
+
+    if (!g_intern_pages[page]) {
+        StrEntry **entries = (StrEntry**)CALLOC_S(STR_INTERN_PAGE_SIZE, sizeof(StrEntry*));
+        if (!entries) return STR_ID_NONE;
+        __atomic_store_n(&g_intern_pages[page], entries, __ATOMIC_RELEASE);
+    }
+
+    if (g_intern_arena.block_size == 0) {
+        mem_arena_init(&g_intern_arena, 64 * 1024);
+    }
+    StrEntry *entry = (StrEntry*)mem_arena_alloc(&g_intern_arena, sizeof(StrEntry) + len + 1, _Alignof(StrEntry));
+    if (!entry) return STR_ID_NONE;
+
+    entry->hash = hash;
+    entry->len = (uint32_t)len;
+    memcpy(entry->text, str, len);
+    entry->text[len] = '\0';
+
+    g_intern_pages[page][id & (STR_INTERN_PAGE_SIZE - 1)] = entry;
+    g_intern_index[pos].hash = hash;
+    g_intern_index[pos].id = id;
+    g_intern_bytes += len + 1;
+
+    // 条目写完后再发布数量，无锁读者只会看到完整条目
+    __atomic_store_n(&g_intern_count, id + 1, __ATOMIC_RELEASE);
+    return id;
+}
+
+// 查找已有字符串，未找到时 pos 为可插入位置
+static StrId str_index_find(const char *str, size_t len, uint32_t hash, uint32_t *pos) {
+    uint32_t i = hash & g_intern_mask;
+    while (g_intern_index[i].id != STR_ID_NONE) {
+        const StrEntry *entry = str_entry(g_intern_index[i].id);
+        if (entry->hash == hash && entry->len == len && memcmp(entry->text, str, len) == 0) {
+            return g_intern_index[i].id;
+        }
+        i = (i + 1) & g_intern_mask;
+    }
+    *pos = i;
+    return STR_ID_NONE;
+}
+
+/* Handle for the first len bytes of str, STR_ID_NONE when empty or out of memory */
+StrId str_intern_n(const char *str, size_t len) {
+    if (!str || len == 0) return STR_ID_NONE;
+
+    uint32_t hash = str_hash(str, len);
+    uint32_t pos;
+    StrId id = STR_ID_NONE;
+
+    pthread_mutex_lock(&g_intern_lock);
+    g_intern_lookups++;
+    // 负载因子保持在 1/2 以下
+    if ((g_intern_count + 1) * 2 <= g_intern_mask + 1 || str_index_grow()) {
+        id = str_index_find(str, len, hash, &pos);
+        if (id == STR_ID_NONE) {
+            id = str_insert(str, len, hash, pos);
+        }
+    }
+    pthread_mutex_unlock(&g_intern_lock);
+    return id;
+}
+
+/* Handle of an already interned string, STR_ID_NONE if it was never seen */
+StrId str_find(const char *str) {
+    if (!str || !*str) return STR_ID_NONE;
+
+    size_t len = strlen(str);
+    uint32_t hash = str_hash(str, len);
+    uint32_t pos;
+    StrId id = STR_ID_NONE;
+
+    pthread_mutex_lock(&g_intern_lock);
+    if (g_intern_index) {
+        id = str_index_find(str, len, hash, &pos);
+    }
+    pthread_mutex_unlock(&g_intern_lock);
+    return id;
+}
+
+StrId str_intern(const char *str) {
+    return str ? str_intern_n(str, strlen(str)) : STR_ID_NONE;
+}
+
+/* Never NULL, unknown handles read as the empty string */
+const char* str_get(StrId id) {
+    if (id == STR_ID_NONE || id >= __atomic_load_n(&g_intern_count, __ATOMIC_ACQUIRE)) return "";
+
+    return str_entry(id)->text;
+}
+
+size_t str_len(StrId id) {
+    if (id == STR_ID_NONE || id >= __atomic_load_n(&g_intern_count, __ATOMIC_ACQUIRE)) return 0;
+
+    return str_entry(id)->len;
+}
+
+void str_intern_print_stats(void) {
+    pthread_mutex_lock(&g_intern_lock);
+    printf("Intern: strings %u, bytes %zu, lookups %zu, index %u\n",
+           g_intern_count - 1, g_intern_bytes, g_intern_lookups, g_intern_mask + 1);
+    pthread_mutex_unlock(&g_intern_lock);
+}
@@ -34,11 +34,11 @@ void* safe_malloc(const size_t size){
 }
 
 void* safe_relloc(void *ptr, const size_t size){
-    void *ptr = relloc(ptr, size);
-    if (ptr == NULL) {
+    void *new_ptr = realloc(ptr, size);
+    if (new_ptr == NULL) {
         printf("Out of memory!!");
     }
-    return ptr;
+    return new_ptr;
 }
 
 void* safe_calloc(const size_t count, const size_t size){
@@ -48,3 +48,240 @@ void* safe_calloc(const size_t count, const size_t size){
     }
     return ptr;
 }
+
+void* safe_aligned_malloc(const size_t alignment, const size_t size){
+    void *ptr = NULL;
+    if (posix_memalign(&ptr, alignment, size) != 0) {
+        printf("Out of memory!!");
+        ptr = NULL;
+    }
+    return ptr;
+}
+
+/* Slab pool */
+
+static inline void mem_pool_lock(MemPool *pool){
+    if (!pool->shared) return;
+    while (__atomic_test_and_set(&pool->lock, __ATOMIC_ACQUIRE)) {
+        /* spin */
+    }
+}
+
+static inline void mem_pool_unlock(MemPool *pool){
+    if (!pool->shared) return;
+    __atomic_clear(&pool->lock, __ATOMIC_RELEASE);
+}
+
+void mem_pool_init(MemPool *pool, const char *name, size_t obj_size, size_t align,
+                   size_t objs_per_slab, bool shared){
+    memset(pool, 0, sizeof(MemPool));
+    pool->name = name;
+    pool->align = MAX(align, sizeof(void*));
+    pool->obj_size = ALIGN_UP(MAX(obj_size, sizeof(void*)), pool->align);
+    pool->objs_per_slab = objs_per_slab ? objs_per_slab : 64;
+    pool->shared = shared;
+}
+
+void mem_pool_destroy(MemPool *pool){
+    void *slab = pool->slabs;
+    while (slab) {
+        void *next = *(void**)slab;
+        free(slab);
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    memset(&pool->stats, 0, sizeof(MemPoolStats));
+}
+
+// 新 slab 头部存放链表指针，其后的对象全部挂入空闲链表
+static bool mem_pool_grow(MemPool *pool){
+    size_t header = ALIGN_UP(sizeof(void*), pool->align);
+    char *slab = (char*)safe_aligned_malloc(pool->align, header + pool->objs_per_slab * pool->obj_size);
+    if (!slab) return false;
+
+    *(void**)slab = pool->slabs;
+    pool->slabs = slab;
+
+    for (size_t i = pool->objs_per_slab; i > 0; i--) {
+        void *obj = slab + header + (i - 1) * pool->obj_size;
+        *(void**)obj = pool->free_list;
+        pool->free_list = obj;
+    }
+
+    pool->stats.slabs++;
+    pool->stats.capacity += pool->objs_per_slab;
+    return true;
+}
+
+void* mem_pool_alloc(MemPool *pool){
+    mem_pool_lock(pool);
+    if (!pool->free_list && !mem_pool_grow(pool)) {
+        mem_pool_unlock(pool);
+        return NULL;
+    }
+
+    void *obj = pool->free_list;
+    pool->free_list = *(void**)obj;
+
+    pool->stats.allocs++;
+    pool->stats.in_use++;
+    if (pool->stats.in_use > pool->stats.peak) {
+        pool->stats.peak = pool->stats.in_use;
+    }
+    mem_pool_unlock(pool);
+    return obj;
+}
+
+void mem_pool_free(MemPool *pool, void *ptr){
+    if (!ptr) return;
+
+    mem_pool_lock(pool);
+    *(void**)ptr = pool->free_list;
+    pool->free_list = ptr;
+
+    pool->stats.frees++;
+    pool->stats.in_use--;
+    mem_pool_unlock(pool);
+}
+
+void mem_pool_print_stats(const MemPool *pool){
+    const MemPoolStats *st = &pool->stats;
+    double usage = st->capacity ? (double)st->in_use / (double)st->capacity : 0.0;
+
+    printf("Pool %s: obj %zu B, slabs %zu, capacity %zu, in use %zu (peak %zu), "
+           "allocs %zu, frees %zu, idle %.1f%%\n",
+           pool->name ? pool->name : "-", pool->obj_size, st->slabs, st->capacity,
+           st->in_use, st->peak, st->allocs, st->frees, (1.0 - usage) * 100.0);
+}
+
+/* Bump-pointer arena */
+
+#define ARENA_BLOCK_DATA(block) ((char*)((block) + 1))
+
+void mem_arena_init(MemArena *arena, size_t block_size){
+    memset(arena, 0, sizeof(MemArena));
+    arena->block_size = block_size ? block_size : 64 * 1024;
+}
+
+void mem_arena_destroy(MemArena *arena){
+    MemArenaBlock *block = arena->first;
+    while (block) {
+        MemArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->first = arena->current = NULL;
+    arena->in_use = 0;
+    memset(&arena->stats, 0, sizeof(MemArenaStats));
+}
+
+static MemArenaBlock* mem_arena_new_block(MemArena *arena, size_t min_size){
+    size_t size = MAX(arena->block_size, min_size);
+    MemArenaBlock *block = (MemArenaBlock*)safe_malloc(sizeof(MemArenaBlock) + size);
+    if (!block) return NULL;
+
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+
+    arena->stats.blocks++;
+    arena->stats.reserved += size;
+    return block;
+}
+
+static inline size_t mem_arena_fit(const MemArenaBlock *block, size_t size, size_t align){
+    uintptr_t base = (uintptr_t)ARENA_BLOCK_DATA(block);
+    size_t offset = (size_t)(ALIGN_UP(base + block->used, (uintptr_t)align) - base);
+    return (offset + size <= block->size) ? offset : SIZE_MAX;
+}
+
+void* mem_arena_alloc(MemArena *arena, size_t size, size_t align){
+    if (align == 0) align = sizeof(void*);
+
+    if (!arena->current) {
+        if (!arena->first) {
+            arena->first = mem_arena_new_block(arena, size + align);
+            if (!arena->first) return NULL;
+        }
+        arena->current = arena->first;
+        arena->current->used = 0;
+    }
+
+    MemArenaBlock *block = arena->current;
+    size_t offset = mem_arena_fit(block, size, align);
+
+    // 当前块不够时依次复用后续块，都放不下才新建并插在当前块之后
+    while (offset == SIZE_MAX) {
+        if (block->next) {
+            block = block->next;
+            block->used = 0;
+        } else {
+            MemArenaBlock *fresh = mem_arena_new_block(arena, size + align);
+            if (!fresh) return NULL;
+            block->next = fresh;
+            block = fresh;
+        }
+        offset = mem_arena_fit(block, size, align);
+    }
+
+    arena->in_use += offset + size - block->used;
+    if (arena->in_use > arena->stats.peak) {
+        arena->stats.peak = arena->in_use;
+    }
+    arena->current = block;
+    block->used = offset + size;
+    return ARENA_BLOCK_DATA(block) + offset;
+}
+
+void mem_arena_reset(MemArena *arena){
+    arena->current = arena->first;
+    if (arena->current) {
+        arena->current->used = 0;
+    }
+    arena->in_use = 0;
+    arena->stats.resets++;
+}
+
+MemArenaMark mem_arena_mark(const MemArena *arena){
+    MemArenaMark mark;
+    mark.block = arena->current;
+    mark.used = arena->current ? arena->current->used : 0;
+    mark.in_use = arena->in_use;
+    return mark;
+}
+
+void mem_arena_release(MemArena *arena, MemArenaMark mark){
+    if (!mark.block) {
+        arena->current = arena->first;
+        if (arena->current) {
+            arena->current->used = 0;
+        }
+    } else {
+        arena->current = mark.block;
+        arena->current->used = mark.used;
+    }
+    arena->in_use = mark.in_use;
+}
+
+void mem_arena_print_stats(const MemArena *arena){
+    const MemArenaStats *st = &arena->stats;
+
+    printf("Arena: blocks %zu, reserved %zu B, in use %zu B (peak %zu B), resets %zu\n",
+           st->blocks, st->reserved, arena->in_use, st->peak, st->resets);
+}
+
+/* Per-thread scratch arena, callers mark on entry and release on exit */
+static __thread MemArena t_scratch_arena;
+
+MemArena* mem_thread_arena(void){
+    if (t_scratch_arena.block_size == 0) {
+        mem_arena_init(&t_scratch_arena, 256 * 1024);
+    }
+    return &t_scratch_arena;
+}
+
+/* Free the calling thread's scratch arena, for worker threads about to exit */
+void mem_thread_arena_destroy(void){
+    mem_arena_destroy(&t_scratch_arena);
+}
@@ -0,0 +1,153 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file timer.c
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "util/timer.h"
+
+uint64_t timer_monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void timer_wheel_init(TimerWheel *wheel, unsigned int tick_ms, uint64_t now_ms) {
+    memset(wheel->slots, 0, sizeof(wheel->slots));
+    wheel->tick_ms = tick_ms ? tick_ms : 1;
+    wheel->tick = now_ms / wheel->tick_ms;
+    wheel->count = 0;
+}
+
+void timer_entry_init(TimerEntry *timer, TimerCallback callback) {
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->expires = 0;
+    timer->callback = callback;
+}
+
+static inline void timer_link(TimerEntry **head, TimerEntry *timer) {
+    timer->next = *head;
+    if (*head) {
+        (*head)->pprev = &timer->next;
+    }
+    *head = timer;
+    timer->pprev = head;
+}
+
+static inline void timer_unlink(TimerEntry *timer) {
+    *timer->pprev = timer->next;
+    if (timer->next) {
+        timer->next->pprev = timer->pprev;
+    }
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+// 按剩余时间选择层级，每层的桶宽是下一层整圈的长度
+static void timer_place(TimerWheel *wheel, TimerEntry *timer) {
+    uint64_t delta = timer->expires - wheel->tick;
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1ULL << ((level + 1) * TIMER_WHEEL_BITS))) {
+        level++;
+    }
+    int index = (timer->expires >> (level * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK;
+    timer_link(&wheel->slots[level][index], timer);
+}
+
+/* Re-arming a pending timer moves it, the callback runs at most once per arm */
+void timer_wheel_arm(TimerWheel *wheel, TimerEntry *timer, uint64_t expires_ms) {
+    if (timer_pending(timer)) {
+        timer_unlink(timer);
+        wheel->count--;
+    }
+
+    // 向上取整，定时器不会早于指定时间触发；已过期的放到下一个 tick
+    uint64_t limit = wheel->tick + (1ULL << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_BITS)) - 1;
+    uint64_t expires = (expires_ms + wheel->tick_ms - 1) / wheel->tick_ms;
+    timer->expires = MIN(MAX(expires, wheel->tick), limit);
+    timer_place(wheel, timer);
+    wheel->count++;
+}
+
+void timer_wheel_cancel(TimerWheel *wheel, TimerEntry *timer) {
+    if (!timer_pending(timer)) return;
+
+    timer_unlink(timer);
+    wheel->count--;
+}
+
+// 上层桶到期时重新分配到下层
+static int timer_cascade(TimerWheel *wheel, int level) {
+    int index = (wheel->tick >> (level * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK;
+    TimerEntry *list = wheel->slots[level][index];
+    wheel->slots[level][index] = NULL;
+
+    while (list) {
+        TimerEntry *timer = list;
+        list = timer->next;
+        timer_place(wheel, timer);
+    }
+    return index;
+}
+
+/*
+ * Run every timer due at or before now_ms, passing arg to the callbacks.
+ * Callbacks may arm or cancel any timer, including the one that fired.
+ * Returns the number of timers that fired.
+ */
+int timer_wheel_advance(TimerWheel *wheel, uint64_t now_ms, void *arg) {
+    uint64_t target = now_ms / wheel->tick_ms;
+    int fired = 0;
+
+    while (wheel->tick <= target) {
+        int index = wheel->tick & TIMER_WHEEL_MASK;
+        if (index == 0) {
+            int level = 1;
+            while (level < TIMER_WHEEL_LEVELS && timer_cascade(wheel, level) == 0) {
+                level++;
+            }
+        }
+
+        // 摘下到期桶后再推进 tick，回调中重新挂入的定时器不会落回本桶
+        TimerEntry *due = wheel->slots[0][index];
+        wheel->slots[0][index] = NULL;
+        if (due) {
+            due->pprev = &due;
+        }
+        wheel->tick++;
+
+        while (due) {
+            TimerEntry *timer = due;
+            timer_unlink(timer);
+            wheel->count--;
+            fired++;
+            timer->callback(timer, arg);
+        }
+
+        // 没有定时器时直接跳到目标 tick
+        if (wheel->count == 0) {
+            wheel->tick = target + 1;
+            break;
+        }
+    }
+    return fired;
+}
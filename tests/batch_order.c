@@ -0,0 +1,99 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file batch_order.c
+ * @brief GraphApplyBatch must end in the same graph as applying in order.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/batch.h"
+#include "test_common.h"
+
+#define ORDER_NODES  8
+#define ORDER_ROUNDS 2000
+#define ORDER_OPS    12
+
+static void order_compare(Graph *batched, Graph *serial) {
+    for (int a = 1; a <= ORDER_NODES; a++) {
+        CHECK((GraphGetNode(batched, a) == NULL) == (GraphGetNode(serial, a) == NULL));
+        for (int b = 1; b <= ORDER_NODES; b++) {
+            EdgeData *x = GraphGetEdge(batched, a, b);
+            EdgeData *y = GraphGetEdge(serial, a, b);
+            CHECK((x == NULL) == (y == NULL));
+            CHECK(!x || x->latency == y->latency);
+        }
+    }
+}
+
+static void order_run(bool directed, unsigned int seed) {
+    Graph *batched = GraphCreate(directed);
+    Graph *serial = GraphCreate(directed);
+    Device device = {0};
+    GraphBatch batch;
+    GraphBatchInit(&batch);
+
+    for (int round = 0; round < ORDER_ROUNDS; round++) {
+        for (int i = 0; i < ORDER_OPS; i++) {
+            int a = 1 + test_rand(&seed) % ORDER_NODES;
+            int b = 1 + test_rand(&seed) % ORDER_NODES;
+            EdgeData edge = {0};
+            edge.latency = (float)(1 + test_rand(&seed) % 100);
+
+            switch (test_rand(&seed) % 4) {
+                case 0:
+                    GraphBatchRemoveNode(&batch, a);
+                    GraphRemoveNode(serial, a);
+                    break;
+                case 1:
+                    GraphBatchUpsertNode(&batch, a, device);
+                    if (GraphGetNode(serial, a)) {
+                        GraphUpdateNode(serial, a, device);
+                    } else {
+                        GraphAddNodeWithId(serial, a, device);
+                    }
+                    break;
+                case 2:
+                    GraphBatchRemoveEdge(&batch, a, b);
+                    GraphRemoveEdge(serial, a, b);
+                    break;
+                default:
+                    // 端点不存在时逐条执行会失败，而批量会先建节点，语义本就不同
+                    if (a == b || !GraphGetNode(serial, a) || !GraphGetNode(serial, b)) break;
+                    GraphBatchUpsertEdge(&batch, a, b, edge);
+                    GraphAddEdge(serial, a, b, edge);
+                    break;
+            }
+        }
+        GraphApplyBatch(batched, &batch);
+        order_compare(batched, serial);
+    }
+
+    GraphBatchFree(&batch);
+    GraphDestroy(batched);
+    GraphDestroy(serial);
+}
+
+int main(void) {
+    order_run(false, 1);
+    order_run(true, 2);
+    puts("batch_order: ok");
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file codec_fuzz.c
+ * @brief Malformed input must make GraphDecode fail, never crash.
+ *
+ * Every truncation of a few encoded samples must be rejected, and random
+ * bit flips and byte edits must either fail or decode into a graph that
+ * encodes again. Built with -DCODEC_LIBFUZZER the same entry point is
+ * handed to libFuzzer instead of main.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/codec.h"
+#include "test_common.h"
+
+#define FUZZ_SAMPLES 4
+#define FUZZ_MUTATIONS 20000
+
+// 解码后的图必须仍然一致：能再次编码并原样解码
+static void fuzz_reencode(Graph *graph) {
+    size_t size = 0;
+    void *buf = GraphEncode(graph, &size);
+    CHECK(buf);
+    Graph *again = GraphDecode(buf, size);
+    CHECK(again && again->node_count == graph->node_count);
+    GraphDestroy(again);
+    FREE_S(buf);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    Graph *graph = GraphDecode(data, size);
+    if (graph) {
+        fuzz_reencode(graph);
+        GraphDestroy(graph);
+    }
+
+    // 失败时已解码的部分保留在目标图中，目标图也必须保持一致
+    Graph *target = GraphCreate(size > 4 && (data[4] & 1));
+    Device device;
+    NodeInit(&device, PLAT_LINUX, SUBPLAT_DEBIAN, "target", "6.1", "x86_64");
+    GraphAddNodeWithId(target, 1, device);
+    GraphDecodeInto(target, data, size);
+    fuzz_reencode(target);
+    GraphDestroy(target);
+    return 0;
+}
+
+#ifndef CODEC_LIBFUZZER
+
+static void* fuzz_sample(int index, size_t *size) {
+    unsigned int seed = 0x9e3779b9u + (unsigned int)index;
+    Graph *graph = GraphCreate(index % 2 == 1);
+    int nodes = 1 + index * 5;
+
+    for (int i = 1; i <= nodes; i++) {
+        char name[32];
+        Device device;
+        snprintf(name, sizeof(name), "node-%d", i % 3);
+        NodeInit(&device, (Platform)(i % PLAT_MAX), (SubPlatType)(i % SUBPLAT_MAX), name, "6.1", "x86_64");
+        device.memory = test_rand(&seed);
+        NodeSetPublicIp(&device, i % 2 ? "203.0.113.7" : NULL, "2001:db8::7");
+        NodeSetPrivateIp(&device, "192.168.1.7", NULL);
+        for (int k = 0; k < i % 3; k++) {
+            NodeAddInterface(&device, k ? "wlan0" : "eth0", "10.0.0.1", NULL, "02:00:00:00:00:01", 1500);
+        }
+        if (device.iface_count > 0) device.iface = &device.ifaces[0];
+        GraphAddNodeWithId(graph, i * 7, device);
+    }
+    for (int i = 0; i < nodes * 3; i++) {
+        EdgeData data = {0};
+        data.bandwidth = test_rand(&seed) % 1000;
+        data.latency = (float)(test_rand(&seed) % 1000) / 10.0f;
+        data.port = 7000;
+        data.last_communication = 1700000000 + i;
+        GraphAddEdge(graph, 7 * (1 + (int)(test_rand(&seed) % nodes)), 7 * (1 + (int)(test_rand(&seed) % nodes)), data);
+    }
+
+    void *buf = GraphEncode(graph, size);
+    CHECK(buf);
+    GraphDestroy(graph);
+    return buf;
+}
+
+static void fuzz_truncate(const uint8_t *buf, size_t size) {
+    for (size_t len = 0; len < size; len++) {
+        // 截断后放到独立分配的缓冲区，越界读才能被检测到
+        uint8_t *copy = (uint8_t*)MALLOC_S(MAX(len, 1));
+        CHECK(copy);
+        memcpy(copy, buf, len);
+        CHECK(GraphDecode(copy, len) == NULL);
+        LLVMFuzzerTestOneInput(copy, len);
+        FREE_S(copy);
+    }
+    Graph *graph = GraphDecode(buf, size);
+    CHECK(graph);
+    GraphDestroy(graph);
+}
+
+static void fuzz_mutate(const uint8_t *buf, size_t size, unsigned int *seed) {
+    uint8_t *copy = (uint8_t*)MALLOC_S(size + 8);
+    CHECK(copy);
+
+    for (int i = 0; i < FUZZ_MUTATIONS; i++) {
+        size_t len = size;
+        memcpy(copy, buf, size);
+        int edits = 1 + (int)(test_rand(seed) % 4);
+        for (int e = 0; e < edits; e++) {
+            size_t at = test_rand(seed) % len;
+            switch (test_rand(seed) % 5) {
+                case 0:
+                    copy[at] ^= (uint8_t)(1u << (test_rand(seed) % 8));
+                    break;
+                case 1:
+                    copy[at] = (uint8_t)test_rand(seed);
+                    break;
+                case 2:
+                    // 变长整数的边界值
+                    copy[at] = test_rand(seed) % 2 ? 0xff : 0x80;
+                    break;
+                case 3:
+                    if (len > 1) {
+                        memmove(copy + at, copy + at + 1, len - at - 1);
+                        len--;
+                    }
+                    break;
+                default:
+                    if (len < size + 8) {
+                        memmove(copy + at + 1, copy + at, len - at);
+                        copy[at] = (uint8_t)test_rand(seed);
+                        len++;
+                    }
+                    break;
+            }
+        }
+        LLVMFuzzerTestOneInput(copy, len);
+    }
+    FREE_S(copy);
+}
+
+int main(void) {
+    unsigned int seed = 1;
+    for (int i = 0; i < FUZZ_SAMPLES; i++) {
+        size_t size = 0;
+        uint8_t *buf = (uint8_t*)fuzz_sample(i, &size);
+        fuzz_truncate(buf, size);
+        fuzz_mutate(buf, size, &seed);
+        FREE_S(buf);
+    }
+    puts("codec_fuzz: ok");
+    return 0;
+}
+
+#endif /* CODEC_LIBFUZZER */
@@ -0,0 +1,257 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file codec_roundtrip.c
+ * @brief Every field written by GraphEncode must come back from GraphDecode.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include <float.h>
+
+#include "discovery/codec.h"
+#include "test_common.h"
+
+#define ROUNDTRIP_NODES  300
+#define ROUNDTRIP_EDGES  1500
+#define ROUNDTRIP_ROUNDS 20
+
+static const char *roundtrip_words[] = { "", "alpha", "beta", "gamma", "eth0", "wlan0", "x86_64", "aarch64" };
+
+static StrId roundtrip_string(unsigned int *seed) {
+    char buf[32];
+    unsigned int pick = test_rand(seed) % 12;
+    if (pick < ARRAY_SIZE(roundtrip_words)) return str_intern(roundtrip_words[pick]);
+    // 少量只出现一次的字符串
+    snprintf(buf, sizeof(buf), "host-%u", test_rand(seed));
+    return str_intern(buf);
+}
+
+static void roundtrip_ip(unsigned int *seed, IPAddress *ip) {
+    memset(ip, 0, sizeof(IPAddress));
+    switch (test_rand(seed) % 3) {
+        case 0:
+            ip->family = AF_INET;
+            ip->address.addr_u32[0] = test_rand(seed);
+            break;
+        case 1:
+            ip->family = AF_INET6;
+            for (int i = 0; i < 4; i++) ip->address.addr_u32[i] = test_rand(seed);
+            break;
+        default:
+            break;
+    }
+}
+
+static uint64_t roundtrip_u64(unsigned int *seed) {
+    uint64_t value = ((uint64_t)test_rand(seed) << 32) | test_rand(seed);
+    // 一半取小值，覆盖短变长整数
+    return test_rand(seed) & 1 ? value : value >> (test_rand(seed) % 64);
+}
+
+static void roundtrip_device(unsigned int *seed, Device *device) {
+    memset(device, 0, sizeof(Device));
+    device->platform = (Platform)(test_rand(seed) % PLAT_MAX);
+    device->subplatform = (SubPlatType)(test_rand(seed) % SUBPLAT_MAX);
+    device->hostname = roundtrip_string(seed);
+    device->os_version = roundtrip_string(seed);
+    device->architecture = roundtrip_string(seed);
+    device->memory = (unsigned long)roundtrip_u64(seed);
+    device->storage = (unsigned long)roundtrip_u64(seed);
+    roundtrip_ip(seed, &device->public_ip);
+    roundtrip_ip(seed, &device->private_ip);
+
+    int ifaces = (int)(test_rand(seed) % 4);
+    for (int k = 0; k < ifaces; k++) {
+        char mac[18];
+        snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x",
+                 test_rand(seed) & 0xff, test_rand(seed) & 0xff, test_rand(seed) & 0xff,
+                 test_rand(seed) & 0xff, test_rand(seed) & 0xff, test_rand(seed) & 0xff);
+        NodeAddInterface(device, NULL, NULL, NULL, test_rand(seed) % 5 ? mac : "", test_rand(seed) % 9001);
+        CHECK(device->iface_count == k + 1);
+        device->ifaces[k].name = roundtrip_string(seed);
+        roundtrip_ip(seed, &device->ifaces[k].ip);
+    }
+    if (ifaces > 0 && test_rand(seed) % 2) {
+        device->iface = &device->ifaces[test_rand(seed) % ifaces];
+    }
+}
+
+static float roundtrip_float(unsigned int *seed) {
+    static const float specials[] = { 0.0f, -0.0f, 1.0f, FLT_MAX, -FLT_MAX, FLT_MIN };
+    unsigned int pick = test_rand(seed) % 16;
+    if (pick < ARRAY_SIZE(specials)) return specials[pick];
+    return (float)(test_rand(seed) % 100000) / 100.0f;
+}
+
+static void roundtrip_edge(unsigned int *seed, EdgeData *data) {
+    memset(data, 0, sizeof(EdgeData));
+    data->utilize = (char)test_rand(seed);
+    data->bandwidth = test_rand(seed) % 3 ? test_rand(seed) % 10000 : test_rand(seed);
+    data->latency = roundtrip_float(seed);
+    data->packet_loss = roundtrip_float(seed);
+    data->port = (unsigned short)test_rand(seed);
+    data->traffic = (unsigned long)roundtrip_u64(seed);
+    data->last_communication = (time_t)(test_rand(seed) % 2 ? 1700000000 + test_rand(seed) % 100000
+                                                           : -(time_t)test_rand(seed));
+}
+
+static void roundtrip_compare_ip(const IPAddress *x, const IPAddress *y) {
+    CHECK(x->family == y->family);
+    CHECK(memcmp(&x->address, &y->address, sizeof(x->address)) == 0);
+}
+
+static void roundtrip_compare_device(const Device *x, const Device *y) {
+    CHECK(x->platform == y->platform);
+    CHECK(x->subplatform == y->subplatform);
+    CHECK(x->hostname == y->hostname);
+    CHECK(x->os_version == y->os_version);
+    CHECK(x->architecture == y->architecture);
+    CHECK(x->memory == y->memory);
+    CHECK(x->storage == y->storage);
+    roundtrip_compare_ip(&x->public_ip, &y->public_ip);
+    roundtrip_compare_ip(&x->private_ip, &y->private_ip);
+    CHECK(x->iface_count == y->iface_count);
+    CHECK((x->iface ? x->iface - x->ifaces : -1) == (y->iface ? y->iface - y->ifaces : -1));
+    for (int k = 0; k < x->iface_count; k++) {
+        CHECK(x->ifaces[k].name == y->ifaces[k].name);
+        roundtrip_compare_ip(&x->ifaces[k].ip, &y->ifaces[k].ip);
+        CHECK(strcmp(x->ifaces[k].mac, y->ifaces[k].mac) == 0);
+        CHECK(x->ifaces[k].mtu == y->ifaces[k].mtu);
+    }
+}
+
+static void roundtrip_compare_edge(const EdgeData *x, const EdgeData *y) {
+    CHECK(x->utilize == y->utilize);
+    CHECK(x->bandwidth == y->bandwidth);
+    // 浮点按位比较，-0.0 也必须保留
+    CHECK(memcmp(&x->latency, &y->latency, sizeof(float)) == 0);
+    CHECK(memcmp(&x->packet_loss, &y->packet_loss, sizeof(float)) == 0);
+    CHECK(x->port == y->port);
+    CHECK(x->traffic == y->traffic);
+    CHECK(x->last_communication == y->last_communication);
+}
+
+// expect 的每个节点和边都必须出现在 actual 中，且字段一致；已有节点更新时不改标记
+static void roundtrip_contains(Graph *actual, Graph *expect, bool flags) {
+    for (int i = 0; i < expect->slot_count; i++) {
+        GraphNode *node = expect->nodes[i];
+        if (!node) continue;
+
+        GraphNode *other = GraphGetNode(actual, node->id);
+        CHECK(other);
+        CHECK(!flags || (other->flags & ~NODE_FLAG_LOCAL) == (node->flags & ~NODE_FLAG_LOCAL));
+        roundtrip_compare_device(GraphNodeDevice(expect, node), GraphNodeDevice(actual, other));
+
+        for (int k = 0; k < node->neighbor_count; k++) {
+            const GraphEdge *edge = &node->edges[k];
+            EdgeData *data = GraphGetEdge(actual, node->id, expect->nodes[edge->slot]->id);
+            CHECK(data);
+            roundtrip_compare_edge(&edge->data, data);
+        }
+    }
+}
+
+static Graph* roundtrip_build(bool directed, unsigned int *seed, int *ids) {
+    Graph *graph = GraphCreate(directed);
+    CHECK(graph);
+
+    for (int i = 0; i < ROUNDTRIP_NODES; i++) {
+        Device device;
+        roundtrip_device(seed, &device);
+        // 稀疏编号覆盖变长差值编码
+        ids[i] = (i == 0 ? 0 : ids[i - 1]) + 1 + (int)(test_rand(seed) % (test_rand(seed) % 4 ? 3 : 100000));
+        GraphNode *node = GraphAddNodeWithId(graph, ids[i], device);
+        CHECK(node);
+        node->flags = test_rand(seed) % (NODE_FLAG_LOCAL | NODE_FLAG_STALE) + 1;
+    }
+    for (int i = 0; i < ROUNDTRIP_EDGES; i++) {
+        int a = ids[test_rand(seed) % ROUNDTRIP_NODES];
+        int b = ids[test_rand(seed) % ROUNDTRIP_NODES];
+        EdgeData data;
+        roundtrip_edge(seed, &data);
+        if (a != b) GraphAddEdge(graph, a, b, data);
+    }
+    // 删除部分节点，留下空槽
+    for (int i = 0; i < ROUNDTRIP_NODES / 10; i++) {
+        GraphRemoveNode(graph, ids[test_rand(seed) % ROUNDTRIP_NODES]);
+    }
+    return graph;
+}
+
+static void roundtrip_run(bool directed, unsigned int seed) {
+    int *ids = (int*)MALLOC_S(ROUNDTRIP_NODES * sizeof(int));
+    CHECK(ids);
+
+    for (int round = 0; round < ROUNDTRIP_ROUNDS; round++) {
+        Graph *graph = roundtrip_build(directed, &seed, ids);
+        size_t size = 0;
+        void *buf = GraphEncode(graph, &size);
+        CHECK(buf && size > 0);
+
+        Graph *decoded = GraphDecode(buf, size);
+        CHECK(decoded);
+        CHECK(decoded->directed == directed);
+        CHECK(decoded->node_count == graph->node_count);
+        roundtrip_contains(decoded, graph, true);
+        roundtrip_contains(graph, decoded, true);
+
+        // 解码到已有图上：已有节点被覆盖，编码中没有的节点保留
+        Graph *target = roundtrip_build(directed, &seed, ids);
+        int extra = 0;
+        for (int i = 0; i < target->slot_count; i++) {
+            if (target->nodes[i] && !GraphGetNode(graph, target->nodes[i]->id)) extra++;
+        }
+        int applied = GraphDecodeInto(target, buf, size);
+        CHECK(applied >= graph->node_count);
+        CHECK(target->node_count == graph->node_count + extra);
+        roundtrip_contains(target, graph, false);
+
+        // 有向性不一致时拒绝
+        Graph *mismatch = GraphCreate(!directed);
+        CHECK(GraphDecodeInto(mismatch, buf, size) == -1);
+        CHECK(mismatch->node_count == 0);
+
+        GraphDestroy(mismatch);
+        GraphDestroy(target);
+        GraphDestroy(decoded);
+        GraphDestroy(graph);
+        FREE_S(buf);
+    }
+
+    // 空图
+    Graph *empty = GraphCreate(directed);
+    size_t size = 0;
+    void *buf = GraphEncode(empty, &size);
+    CHECK(buf);
+    Graph *decoded = GraphDecode(buf, size);
+    CHECK(decoded && decoded->node_count == 0 && decoded->directed == directed);
+    GraphDestroy(decoded);
+    GraphDestroy(empty);
+    FREE_S(buf);
+    FREE_S(ids);
+}
+
+int main(void) {
+    roundtrip_run(false, 1);
+    roundtrip_run(true, 2);
+    puts("codec_roundtrip: ok");
+    return 0;
+}
@@ -0,0 +1,51 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file test_common.h
+ * @brief Minimal checks shared by the test programs.
+ *
+ * A failed CHECK prints the location and exits with status 1, which
+ * `make check` reports as a failure.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#ifndef __TEST_COMMON_H__
+#define __TEST_COMMON_H__
+
+#include "lanpulse_common.h"
+
+#define CHECK(x) do { \
+    if (!(x)) { \
+        fprintf(stderr, "CHECK failed at %s:%d(%s): %s\n", __FILE__, __LINE__, __func__, #x); \
+        exit(1); \
+    } \
+} while (0)
+
+/* xorshift32, deterministic per seed */
+static inline unsigned int test_rand(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+#endif /* __TEST_COMMON_H__ */
@@ -0,0 +1,180 @@
+/*
+ *  Copyright (C) 2025 kkdc <1557655177@qq.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ *  SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/**
+ * @file topology_stress.c
+ * @brief Concurrent readers against a churning topology writer.
+ *
+ * The writer keeps every edge latency equal to the batch number, so a
+ * reader that sees mixed latencies inside one snapshot has caught a torn
+ * publish. Readers also check the CSR shape, that versions never go back,
+ * and run routes on the view. Short-lived reader threads exit without
+ * unregistering to check that their slots come back. Build with
+ * -fsanitize=address or thread to catch reclamation races.
+ *
+ * @author kkdc <1557655177@qq.com>
+ */
+
+#include "discovery/topology.h"
+#include "test_common.h"
+
+#define STRESS_READERS     8
+#define STRESS_NODES       64
+#define STRESS_BATCHES     2000
+#define STRESS_SHORT_LIVED (TOPOLOGY_MAX_READERS * 3)
+
+static volatile int g_stop = 0;
+static unsigned long g_reads[STRESS_READERS];
+
+static void stress_check_view(const GraphSnapshot *snap) {
+    CHECK(snap->offsets[0] == 0);
+    CHECK(snap->offsets[snap->slot_count] == snap->edge_count);
+
+    float latency = snap->edge_count > 0 ? snap->latency[0] : 0;
+    for (int i = 0; i < snap->slot_count; i++) {
+        CHECK(snap->offsets[i] <= snap->offsets[i + 1]);
+        for (int e = snap->offsets[i]; e < snap->offsets[i + 1]; e++) {
+            CHECK(snap->targets[e] >= 0 && snap->targets[e] < snap->slot_count);
+            CHECK(snap->ids[snap->targets[e]] != GRAPH_INVALID_ID);
+            CHECK(snap->latency[e] == latency);
+        }
+    }
+}
+
+static void* stress_reader_main(void *arg) {
+    int index = (int)(intptr_t)arg;
+    unsigned long last_version = 0;
+    unsigned int seed = 0x9e3779b9u + index;
+
+    while (!__atomic_load_n(&g_stop, __ATOMIC_RELAXED)) {
+        const GraphSnapshot *snap = topology_read_begin();
+        if (snap) {
+            CHECK(snap->version >= last_version);
+            last_version = snap->version;
+            stress_check_view(snap);
+
+            // 嵌套读临界区
+            const GraphSnapshot *inner = topology_read_begin();
+            CHECK(inner->version >= snap->version);
+            topology_read_end();
+        }
+        topology_read_end();
+
+        int src = 1 + test_rand(&seed) % STRESS_NODES;
+        int dst = 1 + test_rand(&seed) % STRESS_NODES;
+        Path *path = topology_find_shortest_path(src, dst);
+        if (path) {
+            CHECK(path->node_ids[0] == src && path->node_ids[path->length - 1] == dst);
+            path_destroy(path);
+        }
+        topology_next_hop(src, dst);
+        g_reads[index]++;
+    }
+
+    topology_reader_unregister();
+    mem_thread_arena_destroy();
+    return NULL;
+}
+
+// 不调用 topology_reader_unregister 直接退出
+static void* stress_short_reader_main(void *arg) {
+    const GraphSnapshot *snap = topology_read_begin();
+    CHECK(snap != NULL);
+    topology_read_end();
+    return arg;
+}
+
+static void stress_write_batch(unsigned int *seed, int batch) {
+    Graph *graph = topology_write_begin();
+    EdgeData edge = {0};
+    Device device = {0};
+
+    int node_id = 1 + test_rand(seed) % STRESS_NODES;
+    if (test_rand(seed) % 4 == 0) {
+        GraphRemoveNode(graph, node_id);
+    } else {
+        GraphAddNodeWithId(graph, node_id, device);
+    }
+    for (int i = 0; i < 4; i++) {
+        int from = 1 + test_rand(seed) % STRESS_NODES;
+        int to = 1 + test_rand(seed) % STRESS_NODES;
+        if (from == to || !GraphGetNode(graph, from) || !GraphGetNode(graph, to)) continue;
+        if (test_rand(seed) % 3 == 0) {
+            GraphRemoveEdge(graph, from, to);
+        } else {
+            GraphAddEdge(graph, from, to, edge);
+        }
+    }
+
+    // 所有边统一设为本批次的延迟，先收集再更新，避免边遍历时修改邻接表
+    static int pairs[STRESS_NODES * STRESS_NODES][2];
+    int pair_count = 0;
+    for (int i = 0; i < graph->slot_count; i++) {
+        GraphNode *node = graph->nodes[i];
+        for (int j = 0; node && j < node->neighbor_count; j++) {
+            pairs[pair_count][0] = node->id;
+            pairs[pair_count][1] = graph->nodes[node->edges[j].slot]->id;
+            pair_count++;
+        }
+    }
+    edge.latency = (float)batch;
+    for (int i = 0; i < pair_count; i++) {
+        GraphAddEdge(graph, pairs[i][0], pairs[i][1], edge);
+    }
+    topology_write_end();
+}
+
+int main(void) {
+    CHECK(topology_init(false));
+    CHECK(topology_routing_start(2));
+
+    pthread_t readers[STRESS_READERS];
+    for (int i = 0; i < STRESS_READERS; i++) {
+        CHECK(pthread_create(&readers[i], NULL, stress_reader_main, (void*)(intptr_t)i) == 0);
+    }
+
+    unsigned int seed = 12345;
+    for (int batch = 1; batch <= STRESS_BATCHES; batch++) {
+        stress_write_batch(&seed, batch);
+        if (batch % 10 == 0) {
+            topology_expire();
+        }
+    }
+
+    // 超过槽位数量的短命读者，槽位必须被回收，否则这里会一直等待
+    for (int i = 0; i < STRESS_SHORT_LIVED; i++) {
+        pthread_t thread;
+        CHECK(pthread_create(&thread, NULL, stress_short_reader_main, NULL) == 0);
+        CHECK(pthread_join(thread, NULL) == 0);
+    }
+
+    __atomic_store_n(&g_stop, 1, __ATOMIC_RELAXED);
+    unsigned long reads = 0;
+    for (int i = 0; i < STRESS_READERS; i++) {
+        CHECK(pthread_join(readers[i], NULL) == 0);
+        reads += g_reads[i];
+    }
+
+    topology_synchronize();
+    topology_destroy();
+    topology_reader_unregister();
+    mem_thread_arena_destroy();
+    printf("topology_stress: %d batches, %lu reads\n", STRESS_BATCHES, reads);
+    return 0;
+}